@@ -0,0 +1,362 @@
+// Micro-benchmarks of the CPU kernels.
+//
+// Every case builds a single-operator graph, compiles it once and times
+// repeated runs of the plan, so only the kernel itself is measured. Results
+// are printed as a table and written as JSON for comparing builds.
+//
+// Usage: bench [--filter SUBSTR] [--threads 1,4,...] [--iters N]
+//              [--json PATH]
+
+#include "core/execution_plan.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace infini {
+namespace {
+
+struct BenchCase {
+    string name;
+    // Free-form parameters shown in the report, e.g. shapes and dtype.
+    string params;
+    Graph graph;
+    // Bytes moved and arithmetic operations done by one run.
+    double bytes, flops;
+};
+
+struct BenchResult {
+    string name, params;
+    double bytes, flops;
+    int threads;
+    size_t iters;
+    // Latency percentiles in microseconds.
+    double p50, p90, p99, min;
+};
+
+struct Options {
+    string filter;
+    vector<int> threads;
+    size_t iters = 50;
+    string json = "bench_results.json";
+};
+
+string shapeStr(const Shape &shape) {
+    string ret;
+    for (size_t i = 0; i < shape.size(); ++i)
+        ret += (i ? "x" : "") + std::to_string(shape[i]);
+    return ret;
+}
+
+// Deterministic, finite input data: small values keep floats away from
+// denormals and integer kernels away from overflow and division by zero.
+void fillInput(const Tensor &tensor) {
+    if (tensor->getDType() == DataType::Float32) {
+        float *ptr = tensor->getRawDataPtr<float *>();
+        for (size_t i = 0; i < tensor->size(); ++i)
+            ptr[i] = float(i % 17) * 0.25f - 2.f;
+        return;
+    }
+    uint8_t *ptr = tensor->getRawDataPtr<uint8_t *>();
+    for (size_t i = 0; i < tensor->getBytes(); ++i)
+        ptr[i] = i % 7 + 1;
+}
+
+double totalBytes(const Graph &g) {
+    double bytes = 0;
+    for (auto &tensor : g->getTensors())
+        bytes += tensor->getBytes();
+    return bytes;
+}
+
+// ---------------------------------------------------------------- cases
+
+void addMatmulCases(vector<BenchCase> &cases, Runtime runtime) {
+    struct Config {
+        Shape a, b;
+        bool transA, transB;
+    };
+    const vector<Config> configs = {
+        {{64, 64}, {64, 64}, false, false},
+        {{256, 256}, {256, 256}, false, false},
+        {{512, 512}, {512, 512}, false, false},
+        {{512, 512}, {512, 512}, false, true},
+        {{512, 512}, {512, 512}, true, false},
+        {{1, 1024}, {1024, 1024}, false, false},
+        {{8, 128, 128}, {8, 128, 128}, false, false},
+        {{8, 128, 128}, {128, 128}, false, false},
+    };
+    for (auto dtype : {DataType::Float32, DataType::UInt32})
+        for (auto &c : configs) {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto a = g->addTensor(c.a, dtype);
+            auto b = g->addTensor(c.b, dtype);
+            auto op = g->addOp<MatmulObj>(a, b, nullptr, c.transA, c.transB);
+            double flops = 2.0 * op->getOutput()->size() * op->getK();
+            cases.push_back({"MatMul",
+                             shapeStr(c.a) + (c.transA ? "T" : "") + "*" +
+                                 shapeStr(c.b) + (c.transB ? "T" : "") + " " +
+                                 dtype.toString(),
+                             g, totalBytes(g), flops});
+        }
+}
+
+void addElementWiseCases(vector<BenchCase> &cases, Runtime runtime) {
+    // One entry per broadcast pattern the engine distinguishes.
+    const vector<pair<string, pair<Shape, Shape>>> patterns = {
+        {"same", {{1024, 1024}, {1024, 1024}}},
+        {"row", {{1024, 1024}, {1024}}},
+        {"column", {{1024, 1024}, {1024, 1}}},
+        {"scalar", {{1024, 1024}, {1}}},
+        {"outer", {{1024, 1}, {1, 1024}}},
+        {"middle", {{64, 64, 256}, {64, 1, 256}}},
+    };
+    for (auto dtype : {DataType::Float32, DataType::UInt32})
+        for (auto &[pattern, shapes] : patterns)
+            for (string opName : {"Add", "Mul", "Div"}) {
+                Graph g = make_ref<GraphObj>(runtime);
+                auto a = g->addTensor(shapes.first, dtype);
+                auto b = g->addTensor(shapes.second, dtype);
+                Operator op;
+                if (opName == "Add")
+                    op = g->addOp<AddObj>(a, b, nullptr);
+                else if (opName == "Mul")
+                    op = g->addOp<MulObj>(a, b, nullptr);
+                else
+                    op = g->addOp<DivObj>(a, b, nullptr);
+                cases.push_back({opName,
+                                 pattern + " " + shapeStr(shapes.first) + "," +
+                                     shapeStr(shapes.second) + " " +
+                                     dtype.toString(),
+                                 g, totalBytes(g),
+                                 double(op->getOutput()->size())});
+            }
+}
+
+void addTransposeCases(vector<BenchCase> &cases, Runtime runtime) {
+    const vector<pair<Shape, Shape>> configs = {
+        {{1024, 1024}, {1, 0}},
+        {{64, 128, 256}, {0, 2, 1}},
+        {{64, 128, 256}, {2, 1, 0}},
+        {{64, 128, 256}, {1, 0, 2}},
+        {{8, 64, 64, 64}, {0, 2, 1, 3}},
+        {{8, 64, 64, 64}, {0, 3, 1, 2}},
+    };
+    for (auto dtype : {DataType::Float32, DataType::Float16, DataType::Int8})
+        for (auto &[shape, perm] : configs) {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto input = g->addTensor(shape, dtype);
+            g->addOp<TransposeObj>(input, nullptr, perm);
+            cases.push_back({"Transpose",
+                             shapeStr(shape) + " perm" + vecToString(perm) +
+                                 " " + dtype.toString(),
+                             g, totalBytes(g), 0});
+        }
+}
+
+void addConcatCases(vector<BenchCase> &cases, Runtime runtime) {
+    const Shape shape{64, 128, 256};
+    for (int axis = 0; axis < 3; ++axis)
+        for (int nInputs : {2, 4}) {
+            Graph g = make_ref<GraphObj>(runtime);
+            TensorVec inputs;
+            for (int i = 0; i < nInputs; ++i)
+                inputs.emplace_back(g->addTensor(shape, DataType::Float32));
+            g->addOp<ConcatObj>(inputs, nullptr, axis);
+            cases.push_back({"Concat",
+                             std::to_string(nInputs) + "x" + shapeStr(shape) +
+                                 " axis" + std::to_string(axis),
+                             g, totalBytes(g), 0});
+        }
+}
+
+void addUnaryCases(vector<BenchCase> &cases, Runtime runtime) {
+    const Shape shape{4096, 1024};
+    for (auto dtype : {DataType::Float32, DataType::UInt32}) {
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto op = g->addOp<ReluObj>(g->addTensor(shape, dtype), nullptr);
+            cases.push_back({"Relu", shapeStr(shape) + " " + dtype.toString(),
+                             g, totalBytes(g),
+                             double(op->getOutput()->size())});
+        }
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto op = g->addOp<ClipObj>(g->addTensor(shape, dtype), nullptr,
+                                        0.f, 6.f);
+            cases.push_back({"Clip", shapeStr(shape) + " " + dtype.toString(),
+                             g, totalBytes(g),
+                             2.0 * op->getOutput()->size()});
+        }
+    }
+}
+
+void addCastCases(vector<BenchCase> &cases, Runtime runtime) {
+    const Shape shape{4096, 1024};
+    const vector<tuple<string, DataType, CastType>> configs = {
+        {"Float2Float16", DataType::Float32, CastType::Float2Float16},
+        {"Float162Float", DataType::Float16, CastType::Float162Float},
+        {"Float2BFloat16", DataType::Float32, CastType::Float2BFloat16},
+        {"BFloat162Float", DataType::BFloat16, CastType::BFloat162Float},
+        {"Float2Int32", DataType::Float32, CastType::Float2Int32},
+        {"Int322Float", DataType::Int32, CastType::Int322Float},
+        {"Int642Int32", DataType::Int64, CastType::Int642Int32},
+    };
+    for (auto &[name, dtype, type] : configs) {
+        Graph g = make_ref<GraphObj>(runtime);
+        g->addOp<CastObj>(g->addTensor(shape, dtype), nullptr, type);
+        cases.push_back(
+            {"Cast", name + " " + shapeStr(shape), g, totalBytes(g), 0});
+    }
+}
+
+// ---------------------------------------------------------------- driver
+
+void setThreads(int threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+}
+
+int maxThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+double percentile(const vector<double> &sorted, double p) {
+    size_t idx = std::min(sorted.size() - 1, size_t(p * sorted.size()));
+    return sorted[idx];
+}
+
+BenchResult runCase(const BenchCase &bench, Runtime runtime, int threads,
+                    size_t iters) {
+    setThreads(threads);
+    auto plan = runtime->compile(bench.graph);
+    for (int i = 0; i < 3; ++i)
+        plan->run();
+    vector<double> times;
+    times.reserve(iters);
+    for (size_t i = 0; i < iters; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        plan->run();
+        auto end = std::chrono::steady_clock::now();
+        times.emplace_back(
+            std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+    std::sort(times.begin(), times.end());
+    return {bench.name,
+            bench.params,
+            bench.bytes,
+            bench.flops,
+            threads,
+            iters,
+            percentile(times, 0.5),
+            percentile(times, 0.9),
+            percentile(times, 0.99),
+            times.front()};
+}
+
+void writeJson(const vector<BenchResult> &results, const string &path) {
+    std::ofstream os(path);
+    IT_ASSERT(os.is_open(), "Cannot open " + path);
+    os << std::fixed << std::setprecision(3);
+    os << "{\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto &r = results[i];
+        os << (i ? ",\n" : "\n") << "{\"kernel\":\"" << r.name
+           << "\",\"params\":\"" << r.params
+           << "\",\"threads\":" << r.threads << ",\"iters\":" << r.iters
+           << ",\"p50_us\":" << r.p50 << ",\"p90_us\":" << r.p90
+           << ",\"p99_us\":" << r.p99 << ",\"min_us\":" << r.min
+           << ",\"gb_per_s\":" << r.bytes / r.p50 / 1e3
+           << ",\"gflop_per_s\":" << r.flops / r.p50 / 1e3 << "}";
+    }
+    os << "\n]}\n";
+}
+
+Options parseOptions(int argc, char **argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        IT_ASSERT(i + 1 < argc, "Missing value for " + arg);
+        string value = argv[++i];
+        if (arg == "--filter")
+            opts.filter = value;
+        else if (arg == "--iters")
+            opts.iters = std::stoul(value);
+        else if (arg == "--json")
+            opts.json = value;
+        else if (arg == "--threads") {
+            std::stringstream ss(value);
+            string item;
+            while (std::getline(ss, item, ','))
+                opts.threads.emplace_back(std::stoi(item));
+        } else
+            IT_ASSERT(false, "Unknown option " + arg);
+    }
+    IT_ASSERT(opts.iters > 0);
+    if (opts.threads.empty()) {
+        opts.threads.emplace_back(1);
+        if (maxThreads() > 1)
+            opts.threads.emplace_back(maxThreads());
+    }
+    return opts;
+}
+
+} // namespace
+} // namespace infini
+
+int main(int argc, char **argv) {
+    using namespace infini;
+    auto opts = parseOptions(argc, argv);
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+
+    vector<BenchCase> cases;
+    addMatmulCases(cases, runtime);
+    addElementWiseCases(cases, runtime);
+    addTransposeCases(cases, runtime);
+    addConcatCases(cases, runtime);
+    addUnaryCases(cases, runtime);
+    addCastCases(cases, runtime);
+
+    vector<BenchResult> results;
+    for (auto &bench : cases) {
+        string fullName = bench.name + " " + bench.params;
+        if (fullName.find(opts.filter) == string::npos)
+            continue;
+        bench.graph->dataMalloc();
+        for (auto &input : bench.graph->getInputs())
+            fillInput(input);
+        for (int threads : opts.threads) {
+            auto r = runCase(bench, runtime, threads, opts.iters);
+            std::cout << std::left << std::setw(56) << fullName << std::right
+                      << " t=" << std::setw(3) << threads << std::fixed
+                      << std::setprecision(1) << " p50 " << std::setw(10)
+                      << r.p50 << "us  " << std::setw(8)
+                      << bench.bytes / r.p50 / 1e3 << " GB/s  "
+                      << std::setw(8) << bench.flops / r.p50 / 1e3
+                      << " GFLOP/s" << std::endl;
+            results.emplace_back(std::move(r));
+        }
+        // Release the memory of this case before the next one.
+        bench.graph = nullptr;
+    }
+    writeJson(results, opts.json);
+    std::cout << "Wrote " << results.size() << " results to " << opts.json
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "core/kernel.h"
+#include "utils/thread_pool.h"
+
+namespace infini
+{
+    /**
+     * @brief A graph compiled for repeated execution. Every operator is bound
+     * to its kernel once, with data pointers, shapes, strides and attributes
+     * already extracted, so running the plan is a loop over prepared
+     * routines. The plan must be rebuilt when the graph, tensor shapes or
+     * tensor memory change.
+     *
+     * Steps are stored in topological order. Besides running them one by
+     * one, the plan can run them on a thread pool: a step is submitted as
+     * soon as every step it depends on, through data or through reused
+     * memory, has finished.
+     */
+    class ExecutionPlanObj : public Object
+    {
+    public:
+        struct Step
+        {
+            Operator op;
+            string kernelName;
+            Kernel::Routine routine;
+        };
+
+    private:
+        const RuntimeObj *runtime;
+        vector<Step> steps;
+        // Steps waiting on each step, and how many steps each one waits on.
+        vector<vector<size_t>> dependents;
+        vector<int> numDependencies;
+
+        // Runs one step, timing it if the runtime has profiling enabled.
+        void runStep(const Step &step, Profiler *profiler) const;
+
+    public:
+        ExecutionPlanObj(const Graph &graph, const RuntimeObj *runtime);
+        string toString() const override;
+
+        void run() const;
+        /**
+         * @brief Run independent steps concurrently on `pool` and return
+         * when all of them are done. The first exception thrown by a step
+         * is rethrown here; steps not started by then are skipped.
+         */
+        void run(ThreadPool &pool) const;
+        const vector<Step> &getSteps() const { return steps; }
+    };
+
+} // namespace infini
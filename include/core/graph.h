@@ -1,5 +1,6 @@
 #pragma once
 #include "core/allocator.h"
+#include "core/memory_planner.h"
 #include "core/operator.h"
 #include "core/tensor.h"
 #include <algorithm>
@@ -10,11 +11,34 @@ namespace infini
 
     class GraphObj : public Object
     {
+        friend class GraphRewriter;
+
+    public:
+        /**
+         * @brief How topo_sort orders operators that are ready at the same
+         * time.
+         */
+        enum class Schedule
+        {
+            // The order in which they were added.
+            Insertion,
+            // The order that keeps the fewest tensor bytes live at once.
+            MinMemory,
+        };
+
     protected:
         Runtime runtime;
-        TensorVec tensors;
-        OpVec ops;
+        // Removed tensors and operators leave a null slot until compact().
+        mutable TensorVec tensors;
+        mutable OpVec ops;
         Allocator allocator;
+        // memory of the constant tensors, kept apart from the arena
+        std::unordered_map<TensorObj *, std::shared_ptr<void>> constantMemory;
+        // write-after-read edges introduced by memory reuse in dataMalloc
+        std::unordered_map<OperatorObj *, OpVec> memoryDependencies;
+        // the plan the last run compiled, dropped whenever the graph changes
+        ExecutionPlan cachedPlan;
+        const RuntimeObj *cachedPlanRuntime = nullptr;
 
     public:
         explicit GraphObj(Runtime runtime)
@@ -25,40 +49,177 @@ namespace infini
         Tensor addTensor(Shape dim, DataType dtype = DataType::Float32);
         Tensor addTensor(const Tensor &tensor);
         TensorVec addTensor(const TensorVec &tensors);
-        void removeOperator(Operator op)
+        /**
+         * @brief Add a constant tensor, such as a weight. Its memory is bound
+         * at once in a persistent region that dataMalloc does not touch, so
+         * its data can be set before the graph is optimized.
+         */
+        Tensor addConstant(Shape dim, DataType dtype = DataType::Float32);
+        void removeOperator(const Operator &op);
+        void removeTensor(const Tensor &tensor);
+
+        const TensorVec &getTensors() const
         {
-            auto it = std::find(ops.begin(), ops.end(), op);
-            if (it != ops.end())
-                ops.erase(it);
+            compact();
+            return tensors;
         }
-
-        void removeTensor(Tensor tensor)
+        const OpVec &getOperators() const
         {
-            auto it = std::find(tensors.begin(), tensors.end(), tensor);
-            if (it != tensors.end())
-                tensors.erase(it);
+            compact();
+            return ops;
         }
-
-        const TensorVec &getTensors() const { return tensors; }
-        const OpVec &getOperators() const { return ops; }
         Tensor getTensor(int) const;
 
         void deleteConnection(Tensor tensor, Operator op);
         void addConnection(Tensor tensor, Operator op);
         
         /**
-         * @brief Sort the nodes in topological order.
+         * @brief Sort the nodes in topological order in O(V + E).
          * It returns true if the sorting is successful.
          * Otherwise false is returned, means that there are rings in the graph,
          * so the topological sorting fails.
+         * Edits that keep the current order valid, such as removing edges or
+         * adding an edge that points forward, do not trigger a new sort.
          */
         bool topo_sort();
 
-        void optimize();
+        /**
+         * @brief Choose how topo_sort orders ready operators; call it before
+         * dataMalloc. MinMemory searches all orders of graphs with up to
+         * `exactLimit` operators for the lowest peak of live tensor bytes and
+         * otherwise runs, among the ready operators, the one that frees the
+         * most bytes net of its outputs. The search takes memory exponential
+         * in `exactLimit`, which must not exceed maxExactSchedule.
+         */
+        void setSchedule(Schedule schedule, size_t exactLimit = 16)
+        {
+            IT_ASSERT(exactLimit <= maxExactSchedule);
+            this->schedule = schedule;
+            exactScheduleLimit = exactLimit;
+            sorted = false;
+        }
+        Schedule getSchedule() const { return schedule; }
+        static constexpr size_t maxExactSchedule = 20;
+
+        /**
+         * @brief Run every graph rewrite. `allowPrecisionLoss` also removes
+         * Cast round trips through Float16 or BFloat16.
+         */
+        void optimize(bool allowPrecisionLoss = false);
+
+        /**
+         * @brief Remove operators that copy their input, such as Float2Float
+         * Casts, unbounded Clips, single-input Concats and Add/Sub of zero or
+         * Mul/Div by one constants, and merge chains of Relu/Clip into one
+         * Clip. Cast round trips are removed when the intermediate type holds
+         * every value, and float round trips through Float16 or BFloat16 also
+         * with `allowPrecisionLoss`.
+         */
+        void simplifyAlgebra(bool allowPrecisionLoss = false);
+
+        /**
+         * @brief Evaluate the operators that only read constants once with
+         * the CPU kernels, and replace their outputs with constants.
+         */
+        void foldConstants();
+
+        /**
+         * @brief Merge operators with the same type, attributes and inputs,
+         * so that readers of the duplicates read the first one.
+         */
+        void eliminateCommonSubexpressions();
+
+        /**
+         * @brief Compose chains of Transposes into one, drop identity
+         * permutations and fold swaps of the last two axes into the
+         * transA/transB of the reading MatMul. Transposes that still have
+         * other readers are kept for them.
+         */
+        void simplifyTransposes();
+
+        /**
+         * @brief Move Transposes that feed element-wise operators and Concat
+         * below them, when that does not add Transpose traffic. Inputs that
+         * are broadcast or not transposed get the inverse Transpose, and the
+         * Concat axis is remapped. The moved Transposes are then merged or
+         * cancelled by simplifyTransposes.
+         */
+        void sinkTransposes();
+
+        /**
+         * @brief Fold a bias Add and Relu/Clip that only read a MatMul output
+         * into the MatMul epilogue.
+         */
+        void fuseMatmulEpilogue();
+
+        /**
+         * @brief Reassociate chains of MatMuls whose intermediate results
+         * have a single reader, e.g. (A * B) * C into A * (B * C), choosing
+         * the order with the fewest multiply-adds by dynamic programming.
+         * The bias and epilogue of the last MatMul stay on the new last one.
+         */
+        void reorderMatmulChains();
+
+        /**
+         * @brief Merge MatMuls that read the same A with constant B of the
+         * same K, such as Q/K/V projections, into one MatMul over the B
+         * concatenated along N, and Split its output back into the original
+         * output tensors. A is read once and the wider GEMM keeps more
+         * threads busy. The concatenated B and bias are folded into new
+         * constants.
+         */
+        void fuseHorizontalMatmuls();
+
+        /**
+         * @brief Collapse trees of element-wise operators whose intermediate
+         * results have a single reader into FusedElementWise operators.
+         */
+        void fuseElementWise();
 
         void shape_infer();
 
-        void dataMalloc();
+        /**
+         * @brief Plan and bind the memory of all tensors. The lifetime of
+         * every tensor is computed first, and outputs that a kernel can
+         * write over a dying input share its memory. Offsets are packed with
+         * `strategy`, or with the strategy that gives the lowest peak if none
+         * is given. getMemoryDependencies() reports the ordering this reuse
+         * adds on top of the data dependencies.
+         */
+        void dataMalloc(optional<MemoryPlanner::Strategy> strategy = std::nullopt);
+
+        /**
+         * @brief Plan the memory of all tensors with every strategy without
+         * binding it, e.g. to compare their peak bytes.
+         */
+        vector<MemoryPlanner::Plan> planMemory();
+
+        /**
+         * @brief Operators that must finish before `op` runs because `op`
+         * writes memory they read. Only valid after dataMalloc().
+         */
+        OpVec getMemoryDependencies(const Operator &op) const
+        {
+            auto it = memoryDependencies.find(op.get());
+            return it == memoryDependencies.end() ? OpVec{} : it->second;
+        }
+
+        /**
+         * @brief The plan `runtime` compiled for this graph on an earlier
+         * run, or null. Editing the graph, dataMalloc and shape_infer drop
+         * it; changing a tensor's shape or memory directly needs
+         * invalidatePlan().
+         */
+        ExecutionPlan getCachedPlan(const RuntimeObj *runtime) const
+        {
+            return cachedPlanRuntime == runtime ? cachedPlan : nullptr;
+        }
+        void cachePlan(const ExecutionPlan &plan, const RuntimeObj *runtime)
+        {
+            cachedPlan = plan;
+            cachedPlanRuntime = runtime;
+        }
+        void invalidatePlan() { cachedPlan = nullptr; }
 
         /**
          * @brief Add an operator and create its outputs. Output tensor arguments
@@ -89,7 +250,7 @@ namespace infini
         inline TensorVec getInputs() const
         {
             TensorVec ret;
-            for (const auto &t : tensors)
+            for (const auto &t : getTensors())
                 if (!t->getSource())
                     ret.emplace_back(t);
             return ret;
@@ -101,7 +262,7 @@ namespace infini
         inline TensorVec getOutputs() const
         {
             TensorVec ret;
-            for (const auto &t : tensors)
+            for (const auto &t : getTensors())
                 if (t->getTargets().empty())
                     ret.emplace_back(t);
             return ret;
@@ -110,15 +271,79 @@ namespace infini
         bool checkValid() const;
 
     private:
+        /**
+         * @brief One block per group of non-constant tensors that share
+         * memory, live from the first write to the last read of the group.
+         * A group is a tensor and the outputs written in place over it, see
+         * Kernel::getInPlaceInputs. `blocks` receives the tensors of every
+         * block.
+         */
+        MemoryPlanner memoryLifetimes(vector<TensorVec> &blocks);
+
         /**
          * @brief Add reverse connections and Op relationship in ctor.
          */
         void addOperatorAndConnect(const Operator &op);
 
+        /**
+         * @brief Remove an operator and every edge to it. Its output tensors
+         * stay in the graph without a source.
+         */
+        void removeOperatorAndDisconnect(const Operator &op);
+
+        /**
+         * @brief Mark `tensor` as constant and bind it to persistent memory.
+         */
+        void bindConstant(const Tensor &tensor);
+
+        /**
+         * @brief Point input `index` of `op` at `tensor` and update the edges.
+         */
+        void replaceInput(const Operator &op, size_t index,
+                          const Tensor &tensor);
+
+        /**
+         * @brief Append `tensor` to the inputs of `op` and update the edges.
+         */
+        void addInput(const Operator &op, const Tensor &tensor);
+
+        /**
+         * @brief Make `op` write output `index` to `tensor` and update the
+         * edges. The previous output is left without a source.
+         */
+        void replaceOutput(const Operator &op, size_t index,
+                           const Tensor &tensor);
+
+        /**
+         * @brief Point every reader of `from` at `to`.
+         */
+        void replaceAllUses(const Tensor &from, const Tensor &to);
+
         /**
          * @brief If the nodes is sorted in topological order.
          */
         bool sorted;
+
+        Schedule schedule = Schedule::Insertion;
+        size_t exactScheduleLimit = 16;
+        // The slot of each operator in `ops` and of each tensor in
+        // `tensors`, and the number of null slots left by removals.
+        mutable std::unordered_map<OperatorObj *, size_t> position;
+        mutable std::unordered_map<TensorObj *, size_t> tensorPosition;
+        mutable size_t removedOps = 0, removedTensors = 0;
+        std::unordered_map<UidBaseType, Tensor> tensorByFuid;
+
+        /**
+         * @brief Drop the null slots of `ops` and `tensors` in one pass and
+         * renumber the slots. Every reader of the vectors calls it first.
+         */
+        void compact() const;
+
+        /**
+         * @brief Keep `sorted` only if the new edge from `from` to `to`
+         * agrees with the current order.
+         */
+        void orderEdge(const Operator &from, const Operator &to);
     };
 
 } // namespace infini
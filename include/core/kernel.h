@@ -13,6 +13,12 @@ namespace infini
     class Kernel
     {
     public:
+        /**
+         * @brief An op bound to a kernel: data pointers, shapes and attributes
+         * are resolved, calling it only does the computation.
+         */
+        using Routine = std::function<void()>;
+
         Kernel() {}
         virtual ~Kernel() {}
 
@@ -21,6 +27,51 @@ namespace infini
          */
         virtual void compute(const Operator &op,
                              const RuntimeObj *context) const = 0;
+
+        /**
+         * @brief Resolves everything the kernel needs from the op ahead of
+         * time. The routine stays valid as long as the op's tensors keep
+         * their shapes and data blobs.
+         */
+        virtual Routine prepare(const Operator &op,
+                                const RuntimeObj *context) const
+        {
+            return [this, op, context]
+            { compute(op, context); };
+        }
+
+        /**
+         * @brief Indices of the inputs of `op` the kernel can write its
+         * output over: every output element is written after the element at
+         * the same offset of such an input has been read. dataMalloc lets
+         * the output take the memory of such an input when `op` reads it
+         * last.
+         */
+        virtual vector<int> getInPlaceInputs(const Operator &op) const
+        {
+            return {};
+        }
+
+    protected:
+        /**
+         * @brief Inputs of `op` laid out like its single output: same shape
+         * and the same element size.
+         */
+        static vector<int> sameLayoutInputs(const Operator &op)
+        {
+            vector<int> ret;
+            if (op->numOutputs() != 1)
+                return ret;
+            auto output = op->getOutput();
+            for (int i = 0; i < op->numInputs(); ++i)
+            {
+                auto input = op->getInputs(i);
+                if (input->getDims() == output->getDims() &&
+                    input->getDType().getSize() == output->getDType().getSize())
+                    ret.emplace_back(i);
+            }
+            return ret;
+        }
     };
 
     class KernelRegistry
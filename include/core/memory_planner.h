@@ -0,0 +1,73 @@
+#pragma once
+#include "core/common.h"
+
+namespace infini
+{
+    /**
+     * @brief Offline planner for the memory arena of a graph. Every block
+     * is known up front with its size and lifetime, an inclusive range of
+     * steps, so offsets can be packed globally instead of in allocation
+     * order. Blocks whose lifetimes overlap never share bytes.
+     */
+    class MemoryPlanner
+    {
+    public:
+        enum class Strategy
+        {
+            // Largest blocks first, each in the smallest gap that fits.
+            GreedyBySize,
+            // Steps with the most live bytes first; their blocks are placed
+            // largest first, each in the smallest gap that fits.
+            GreedyByBreadth,
+            // Blocks in order of their first step, each at the lowest offset
+            // that fits: first-fit colouring of the interval graph.
+            IntervalColoring,
+        };
+        static constexpr Strategy strategies[] = {Strategy::GreedyBySize,
+                                                  Strategy::GreedyByBreadth,
+                                                  Strategy::IntervalColoring};
+
+        struct Plan
+        {
+            Strategy strategy;
+            // Offset of every block, in the order they were added.
+            vector<size_t> offsets;
+            size_t peak;
+        };
+
+    private:
+        struct Block
+        {
+            size_t size, first, last;
+        };
+        size_t alignment;
+        vector<Block> blocks;
+
+        // Lowest offset, or with `bestFit` the smallest gap, where a block
+        // of `size` fits between the placed blocks that live at the same
+        // time as block `id`.
+        size_t findOffset(size_t id, const vector<size_t> &offsets,
+                          const vector<bool> &placed, bool bestFit) const;
+
+    public:
+        explicit MemoryPlanner(size_t alignment = sizeof(uint64_t))
+            : alignment(alignment) {}
+
+        /**
+         * @brief Add a block of `bytes` live from step `first` to step
+         * `last`, both included. Returns its index.
+         */
+        size_t addBlock(size_t bytes, size_t first, size_t last);
+        size_t size() const { return blocks.size(); }
+
+        Plan plan(Strategy strategy) const;
+        /**
+         * @brief Plan with every strategy and return the plan with the
+         * lowest peak.
+         */
+        Plan planBest() const;
+
+        static const char *toString(Strategy strategy);
+    };
+
+} // namespace infini
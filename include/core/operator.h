@@ -54,6 +54,12 @@ namespace infini
         DataType getOutDType() const { return getOutput()->getDType(); }
         virtual int numInputs() const = 0;
         virtual int numOutputs() const = 0;
+        /**
+         * @brief The operator type followed by every attribute that affects
+         * the result. Operators with equal vectors and equal inputs compute
+         * equal outputs.
+         */
+        virtual vector<int> getOpAttrVector() const;
 
         /**
          * @brief Clone this operator and replace its inputs and outputs.
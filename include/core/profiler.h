@@ -0,0 +1,56 @@
+#pragma once
+#include "core/common.h"
+#include "core/runtime.h"
+#include <chrono>
+#include <mutex>
+
+namespace infini
+{
+    /**
+     * @brief Collects the wall time of every kernel run while profiling is
+     * enabled on the runtime. Records may come from several threads at once.
+     */
+    class Profiler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Record
+        {
+            string opType;
+            string kernelName;
+            string shapes;
+            string dtype;
+            // Small sequential id of the thread that ran the kernel.
+            int threadId;
+            // Microseconds since the profiler was created or cleared.
+            double start, duration;
+        };
+
+    private:
+        mutable std::mutex mutex;
+        vector<Record> records;
+        Clock::time_point epoch;
+
+    public:
+        Profiler() : epoch(Clock::now()) {}
+
+        void record(const Operator &op, const string &kernelName,
+                    Clock::time_point begin, Clock::time_point end);
+        void clear();
+        vector<Record> getRecords() const;
+
+        /**
+         * @brief Print count, total, mean and share of the wall time per op
+         * type, slowest first.
+         */
+        void printSummary(std::ostream &os = std::cout) const;
+        /**
+         * @brief Write the records in the Trace Event Format read by
+         * chrome://tracing and Perfetto.
+         */
+        void exportChromeTrace(const string &path) const;
+        void exportChromeTrace(std::ostream &os) const;
+    };
+
+} // namespace infini
@@ -1,5 +1,6 @@
 #pragma once
 #include "core/common.h"
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -32,6 +33,17 @@ std::vector<WRef<T>> refs_to_wrefs(const std::vector<Ref<T>> &refs) {
     return wrefs;
 }
 
+// Remove every reference to `ref` without locking the weak references.
+template <typename T>
+void erase_wrefs(std::vector<WRef<T>> &wrefs, const Ref<T> &ref) {
+    wrefs.erase(std::remove_if(wrefs.begin(), wrefs.end(),
+                               [&](const WRef<T> &wref) {
+                                   return !wref.owner_before(ref) &&
+                                          !ref.owner_before(wref);
+                               }),
+                wrefs.end());
+}
+
 template <typename T>
 std::vector<Ref<T>> wrefs_to_refs(const std::vector<WRef<T>> &wrefs) {
     std::vector<Ref<T>> refs;
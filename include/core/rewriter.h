@@ -0,0 +1,156 @@
+#pragma once
+#include "core/graph.h"
+#include <deque>
+#include <unordered_set>
+
+namespace infini
+{
+    /**
+     * @brief A subgraph template matched against the producers of an
+     * operator. A pattern either matches any tensor, or an operator of one of
+     * the given types that satisfies every predicate and whose inputs match
+     * the operand patterns in order.
+     */
+    class Pattern
+    {
+    public:
+        using Predicate = std::function<bool(const Operator &)>;
+
+        /**
+         * @brief Match any tensor, whatever produces it.
+         */
+        static Pattern any();
+        /**
+         * @brief Match an operator of `type`. Inputs beyond the operand
+         * patterns are not looked at.
+         */
+        static Pattern op(OpType type, vector<Pattern> operands = {});
+        /**
+         * @brief Match an operator of any of `types`, or of any type if
+         * `types` is empty.
+         */
+        static Pattern op(vector<OpType> types, vector<Pattern> operands = {});
+
+        /**
+         * @brief Require `pred` to hold for the matched operator.
+         */
+        Pattern &where(Predicate pred);
+        /**
+         * @brief Require the matched operator's output to be read by the
+         * parent operator only, so the rewrite may consume it.
+         */
+        Pattern &singleUse();
+        /**
+         * @brief Also try the two operand patterns in swapped order.
+         */
+        Pattern &commutative();
+
+        /**
+         * @brief Match the pattern rooted at `op`. On success the matched
+         * operators are appended to `matched` in pre-order, `op` first.
+         */
+        bool match(const Operator &op, OpVec &matched) const;
+
+    private:
+        bool anyTensor = false;
+        vector<OpType> types;
+        vector<Predicate> predicates;
+        vector<Pattern> operands;
+        bool oneUse = false, swappable = false;
+
+        bool matchOperand(const Pattern &pattern, const Tensor &tensor,
+                          const Operator &parent, OpVec &matched) const;
+        bool matchOperands(const Operator &op, const vector<int> &order,
+                           OpVec &matched) const;
+    };
+
+    class GraphRewriter;
+
+    /**
+     * @brief A rewrite applied wherever `pattern` matches. `rewrite` gets
+     * the matched operators in pre-order and returns whether it changed the
+     * graph; it may decline a match, e.g. when the change does not pay off.
+     */
+    struct RewriteRule
+    {
+        string name;
+        Pattern pattern;
+        std::function<bool(const OpVec &, GraphRewriter &)> rewrite;
+    };
+
+    /**
+     * @brief Applies rewrite rules to a fixpoint. Every operator starts on a
+     * worklist in topological order; the rules are tried on each one in
+     * order. The edit methods below keep tensors and predecessor/successor
+     * edges consistent and put every operator an edit may have enabled a
+     * rule for back on the worklist.
+     */
+    class GraphRewriter
+    {
+    public:
+        explicit GraphRewriter(GraphObj &graph) : graph(graph) {}
+
+        /**
+         * @brief Apply `rules` until none of them matches any more. Returns
+         * whether the graph changed.
+         */
+        bool apply(const vector<RewriteRule> &rules);
+
+        GraphObj &getGraph() const { return graph; }
+
+        Tensor addTensor(Shape dim, DataType dtype);
+        /**
+         * @brief Add an operator and create its outputs.
+         */
+        template <typename T, typename... Args>
+        Ref<T> create(Args &&...args)
+        {
+            auto op = graph.addOp<T>(std::forward<Args>(args)...);
+            created(op);
+            return op;
+        }
+        /**
+         * @brief Add an operator writing to existing output tensors.
+         */
+        template <typename T, typename... Args>
+        Ref<T> createWithOutputs(Args &&...args)
+        {
+            auto op = graph.addOpWithOutputs<T>(std::forward<Args>(args)...);
+            created(op);
+            return op;
+        }
+
+        void replaceInput(const Operator &op, size_t index,
+                          const Tensor &tensor);
+        void addInput(const Operator &op, const Tensor &tensor);
+        void replaceOutput(const Operator &op, size_t index,
+                           const Tensor &tensor);
+        void replaceAllUses(const Tensor &from, const Tensor &to);
+        /**
+         * @brief Tell the driver that the attributes of `op` changed.
+         */
+        void updated(const Operator &op) { push(op); }
+        /**
+         * @brief Remove `op`. Its outputs stay in the graph without a
+         * source, so another operator can take them over; inputs left with
+         * neither a source nor a reader are removed.
+         */
+        void eraseOp(const Operator &op);
+        /**
+         * @brief Remove `op` and its outputs if nothing reads them.
+         */
+        bool eraseIfUnread(const Operator &op);
+
+    private:
+        GraphObj &graph;
+        std::deque<Operator> worklist;
+        std::unordered_set<Operator> queued, erased;
+
+        void push(const Operator &op);
+        // Queue the producer and the readers of `tensor`.
+        void touch(const Tensor &tensor);
+        void created(const Operator &op);
+        void removeIfDangling(const Tensor &tensor);
+    };
+
+} // namespace infini
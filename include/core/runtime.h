@@ -2,6 +2,7 @@
 #include "core/common.h"
 #include "core/op_type.h"
 #include "core/ref.h"
+#include "utils/thread_pool.h"
 
 namespace infini
 {
@@ -10,12 +11,15 @@ namespace infini
   class GraphObj;
   class RuntimeObj;
   class BlobObj;
+  class ExecutionPlanObj;
+  class Profiler;
 
   using Tensor = Ref<TensorObj>;
   using Operator = Ref<OperatorObj>;
   using Graph = Ref<GraphObj>;
   using Runtime = Ref<RuntimeObj>;
   using Blob = Ref<BlobObj>;
+  using ExecutionPlan = Ref<ExecutionPlanObj>;
 
   using TensorVec = vector<Tensor>;
   using OpVec = vector<Operator>;
@@ -29,6 +33,8 @@ namespace infini
   {
   protected:
     Device device;
+    // Set while profiling is enabled.
+    Ref<Profiler> profiler;
 
   public:
     explicit RuntimeObj(Device device)
@@ -37,10 +43,28 @@ namespace infini
     RuntimeObj &operator=(RuntimeObj const &) = delete;
     virtual ~RuntimeObj() {}
 
+    /**
+     * @brief Run a graph whose memory is allocated. The compiled plan is
+     * cached on the graph and rebuilt only once the graph changes.
+     */
     virtual void run(const Graph &graph) const = 0;
     virtual void *alloc(size_t size) = 0;
     virtual void dealloc(void *ptr) = 0;
 
+    /**
+     * @brief Resolve the kernels of a graph whose memory is allocated into
+     * an execution plan that can be run repeatedly.
+     */
+    ExecutionPlan compile(const Graph &graph) const;
+
+    /**
+     * @brief Time every kernel run from now on, or stop doing so. Enabling
+     * starts a new, empty profiler.
+     */
+    void setProfiling(bool enable);
+    Ref<Profiler> getProfiler() const { return profiler; }
+
+    Device getDevice() const { return device; }
     bool isCpu() const
     {
       return true;
@@ -51,6 +75,10 @@ namespace infini
 
   class NativeCpuRuntimeObj : public RuntimeObj
   {
+    // Workers running independent operators concurrently; null when the
+    // graph runs sequentially on the calling thread.
+    std::unique_ptr<ThreadPool> pool;
+
   public:
     NativeCpuRuntimeObj() : RuntimeObj(Device::CPU) {}
 
@@ -62,6 +90,13 @@ namespace infini
     }
     void dealloc(void *ptr) override;
     void run(const Graph &graph) const override;
+    /**
+     * @brief Split the cores between operators running concurrently
+     * (inter-op) and the OpenMP team of each operator (intra-op). With one
+     * inter-op thread the graph runs sequentially. An intra-op count of 0
+     * divides the OpenMP threads evenly among the inter-op threads.
+     */
+    void setParallelism(size_t interOpThreads, int intraOpThreads = 0);
     void *alloc(size_t size) override;
     string toString() const override;
   };
@@ -24,6 +24,8 @@ namespace infini
         WRef<OperatorObj> source;
         Blob data;
         Runtime runtime;
+        // Weights and other initializers, see GraphObj::addConstant.
+        bool constant = false;
 
     private:
         Shape shape;
@@ -71,6 +73,7 @@ namespace infini
 
         DataType getDType() const { return dtype; }
         Runtime getRuntime() const { return runtime; }
+        bool isConstant() const { return constant; }
 
         OpVec getTargets() const { return wrefs_to_refs(targets); }
         Operator getSource() const { return source.lock(); }
@@ -149,16 +152,7 @@ namespace infini
 
         void addTarget(const Operator &op) { targets.emplace_back(op); }
         void setSource(const Operator &op) { source = op; }
-        void removeTarget(const Operator &op)
-        {
-            for (auto itr = targets.begin(); itr != targets.end();)
-            {
-                if (itr->lock() == op)
-                    itr = targets.erase(itr);
-                else
-                    ++itr;
-            }
-        }
+        void removeTarget(const Operator &op) { erase_wrefs(targets, op); }
     };
 
 } // namespace infini
@@ -25,8 +25,10 @@ class ConcatObj : public OperatorObj {
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
 
     std::string toString() const override;
+    vector<int> getOpAttrVector() const override;
     int numInputs() const override { return inputs.size(); }
     int numOutputs() const override { return 1; }
     int getDim() const { return dim; }
+    void setDim(int dim) { this->dim = dim; }
 };
 } // namespace infini
@@ -0,0 +1,58 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini
+{
+  /**
+   * @brief A tree of element-wise operators (Add, Sub, Mul, Div, Relu, Clip)
+   * evaluated in one pass over the output, so intermediate results never
+   * reach memory. Built by GraphObj::optimize.
+   *
+   */
+  class FusedElementWiseObj : public OperatorObj
+  {
+  public:
+    /**
+     * @brief One step of the fused expression. Operands index the value
+     * list: the inputs of the operator come first, followed by the result of
+     * every preceding instruction. The last instruction produces the output.
+     */
+    struct Instruction
+    {
+      OpType type;
+      int lhs;
+      // Second operand of binary instructions, -1 for unary ones.
+      int rhs;
+      // Bounds of Clip instructions.
+      std::optional<float> min, max;
+    };
+
+    /**
+     * @brief Construct a new FusedElementWise object
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param inputs The leaf tensors of the expression.
+     * @param output The output tensor.
+     * @param program The expression, in evaluation order.
+     */
+    FusedElementWiseObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                        vector<Instruction> program);
+    OP_CLONE(FusedElementWiseObj);
+
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    std::string toString() const override;
+    vector<int> getOpAttrVector() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+
+    const vector<Instruction> &getProgram() const { return program; }
+    /**
+     * @brief Whether `type` can be part of a fused expression.
+     */
+    static bool isFusible(OpType type);
+
+  private:
+    vector<Instruction> program;
+  };
+
+}; // namespace infini
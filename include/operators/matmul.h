@@ -9,12 +9,25 @@ namespace infini
      */
     class MatmulObj : public OperatorObj
     {
+    public:
+        /**
+         * @brief Work applied to each output element before it is stored:
+         * C = clamp(A * B + bias, min, max). The bias is the optional third
+         * input and a Relu is a clamp with min = 0.
+         */
+        struct Epilogue
+        {
+            std::optional<float> min, max;
+        };
+
     private:
         // InfiniTensor assumes a row-major tensor layout. `transA`=false means
         // default dims, true means A should be transposed before matmul. This is in
         // oppsite to the column-major BLAS.
         bool transA, transB;
 
+        Epilogue epilogue;
+
         // Auxiliary attributes which are not a part of operator attributes.
         int m, n, k;
 
@@ -37,12 +50,17 @@ namespace infini
          * the constructor, C should be an empty Ref.
          * @param transA If matrix A should be transposed when computing.
          * @param transB If matrix B should be transposed when computing.
+         * @param bias Optional bias added to every row of the output: its last
+         * dimension is n or 1 and all other dimensions are 1.
+         * @param epilogue Clamp applied after the bias.
          */
         MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C,
-                  bool transA = false, bool transB = false);
+                  bool transA = false, bool transB = false,
+                  Tensor bias = nullptr, Epilogue epilogue = {});
         OP_CLONE(MatmulObj);
 
         std::string toString() const override;
+        vector<int> getOpAttrVector() const override;
         optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
 
         int numInputs() const override { return inputs.size(); }
@@ -52,6 +70,9 @@ namespace infini
         bool getTransB() const { return transB; }
         void setTransA(bool transA) { this->transA = transA; }
         void setTransB(bool transB) { this->transB = transB; }
+        Tensor getBias() const { return inputs.size() > 2 ? inputs[2] : nullptr; }
+        const Epilogue &getEpilogue() const { return epilogue; }
+        void setEpilogue(const Epilogue &epilogue) { this->epilogue = epilogue; }
         int getM() const { return m; }
         int getN() const { return n; }
         int getK() const { return k; }
@@ -0,0 +1,39 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Split a tensor into consecutive slices along one dimension. It is
+ * the inverse of Concat.
+ *
+ */
+class SplitObj : public OperatorObj {
+    int dim;
+    vector<int> sizes;
+
+  public:
+    /**
+     * @brief Construct a new Split object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The tensor to be split.
+     * @param outputs The slices in order. If outputs are going to be created
+     * in the constructor, outputs should be std::nullopt.
+     * @param dim The dimension to split on.
+     * @param sizes The length of every slice along `dim`. They add up to the
+     * length of `input` along `dim`.
+     */
+    SplitObj(GraphObj *graph, Tensor input, std::optional<TensorVec> outputs,
+             int dim, vector<int> sizes);
+    OP_CLONE(SplitObj);
+
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    vector<int> getOpAttrVector() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return sizes.size(); }
+    int getDim() const { return dim; }
+    const vector<int> &getSizes() const { return sizes; }
+};
+} // namespace infini
@@ -24,9 +24,15 @@ namespace infini
     optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
 
     std::string toString() const override;
+    vector<int> getOpAttrVector() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
     std::vector<int> getPermute() const { return transposePermute; }
+    void setPermute(vector<int> permute)
+    {
+      IT_ASSERT(permute.size() == transposePermute.size());
+      transposePermute = std::move(permute);
+    }
 
   private:
     vector<int> transposePermute;
@@ -5,7 +5,9 @@
 #include "core/operator.h"
 #include "core/tensor.h"
 
+#include <limits>
 #include <numeric>
+#include <type_traits>
 
 namespace infini {
 
@@ -18,6 +20,36 @@ Shape locate_index(size_t inputN, const Shape &shape);
 // Delocate the ShapeIndex from Shape with broadcast
 size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
                       const Shape &stride);
+// Collapse the broadcast of `inputs` onto `output` into as few dimensions as
+// possible. Inputs are padded to the output rank, size-1 output dimensions are
+// dropped and adjacent dimensions are merged when every input either keeps or
+// broadcasts both of them. Afterwards each input dimension equals either the
+// output dimension or 1.
+void collapse_broadcast(Shape &output, vector<Shape> &inputs);
+// Permutation equivalent to applying Transpose `first`, then `second`
+vector<int> compose_permutation(const vector<int> &first,
+                                const vector<int> &second);
+// Permutation undoing `perm`
+vector<int> inverse_permutation(const vector<int> &perm);
+// Whether `perm` leaves every axis in place
+bool is_identity_permutation(const vector<int> &perm);
+// Whether `perm` swaps the last two axes and leaves the others in place
+bool is_last_two_axes_swap(const vector<int> &perm);
+// Append an optional float attribute to an attribute vector as its presence
+// and its bit pattern
+void append_float_attr(vector<int> &attrs, std::optional<float> value);
+// Whether every value of `from` converts to `to` and back unchanged
+bool is_exact_conversion(DataType from, DataType to);
+// Convert a float clamp bound to T; integer bounds saturate to T's range
+template <typename T> T cast_bound(float bound) {
+    if constexpr (std::is_integral_v<T>) {
+        if (bound <= (float)std::numeric_limits<T>::lowest())
+            return std::numeric_limits<T>::lowest();
+        if (bound >= (float)std::numeric_limits<T>::max())
+            return std::numeric_limits<T>::max();
+    }
+    return (T)bound;
+}
 // Convert KernelAttrs to a string representation
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs);
 
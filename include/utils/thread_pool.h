@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace infini {
+
+// A fixed set of workers, each owning a task deque. A worker pops the newest
+// task of its own deque (the one most likely still in cache) and, when that
+// runs dry, steals the oldest task of another worker. Tasks submitted from a
+// worker go to that worker's deque; tasks submitted from outside are spread
+// round-robin.
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    // `intraOpThreads` is the OpenMP team size of every worker, so kernels
+    // running concurrently on the pool do not oversubscribe the cores.
+    ThreadPool(size_t numThreads, int intraOpThreads = 1);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(Task task);
+
+    size_t getNumThreads() const { return workers.size(); }
+    int getIntraOpThreads() const { return intraOpThreads; }
+
+  private:
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    int intraOpThreads;
+    std::atomic<size_t> nextWorker{0};
+
+    // Workers with nothing to do sleep on `wakeUp` until `pending` tasks
+    // show up or the pool stops.
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<size_t> pending{0};
+    bool stopping = false;
+
+    void workerLoop(size_t id);
+    bool popTask(size_t id, Task &task);
+};
+
+} // namespace infini
@@ -0,0 +1,129 @@
+#include "core/execution_plan.h"
+#include "core/graph.h"
+#include "core/profiler.h"
+#include <atomic>
+
+namespace infini
+{
+    ExecutionPlanObj::ExecutionPlanObj(const Graph &graph,
+                                       const RuntimeObj *runtime)
+        : runtime(runtime)
+    {
+        IT_ASSERT(graph->topo_sort() == true);
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        const auto &ops = graph->getOperators();
+        steps.reserve(ops.size());
+        for (auto &op : ops)
+        {
+            auto kernelAttrs =
+                KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+            Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
+            const auto &kernelName =
+                std::get<1>(kernelRegistry.getKernelItem(kernelAttrs));
+            steps.emplace_back(Step{op, kernelName, kernel->prepare(op, runtime)});
+        }
+
+        std::unordered_map<OperatorObj *, size_t> index;
+        for (size_t i = 0; i < ops.size(); ++i)
+            index[ops[i].get()] = i;
+        dependents.resize(ops.size());
+        numDependencies.resize(ops.size());
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            std::unordered_set<size_t> deps;
+            for (auto &pred : ops[i]->getPredecessors())
+                deps.insert(index.at(pred.get()));
+            for (auto &pred : graph->getMemoryDependencies(ops[i]))
+                deps.insert(index.at(pred.get()));
+            for (size_t dep : deps)
+                dependents[dep].emplace_back(i);
+            numDependencies[i] = deps.size();
+        }
+    }
+
+    void ExecutionPlanObj::runStep(const Step &step, Profiler *profiler) const
+    {
+        if (!profiler)
+        {
+            step.routine();
+            return;
+        }
+        auto begin = Profiler::Clock::now();
+        step.routine();
+        profiler->record(step.op, step.kernelName, begin,
+                         Profiler::Clock::now());
+    }
+
+    void ExecutionPlanObj::run() const
+    {
+        auto profiler = runtime->getProfiler();
+        for (auto &step : steps)
+            runStep(step, profiler.get());
+    }
+
+    void ExecutionPlanObj::run(ThreadPool &pool) const
+    {
+        const size_t n = steps.size();
+        if (n == 0)
+            return;
+        auto profiler = runtime->getProfiler();
+        auto waiting = std::make_unique<std::atomic<int>[]>(n);
+        for (size_t i = 0; i < n; ++i)
+            waiting[i] = numDependencies[i];
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        size_t unfinished = n;
+        std::mutex mutex;
+        std::condition_variable done;
+
+        std::function<void(size_t)> launch = [&](size_t i)
+        {
+            pool.submit(
+                [&, i]
+                {
+                    if (!failed)
+                    {
+                        try
+                        {
+                            runStep(steps[i], profiler.get());
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (!error)
+                                error = std::current_exception();
+                            failed = true;
+                        }
+                    }
+                    // Released steps go to this worker's own deque, so a
+                    // chain of ops tends to stay on one core.
+                    for (size_t next : dependents[i])
+                        if (--waiting[next] == 0)
+                            launch(next);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (--unfinished == 0)
+                        done.notify_all();
+                });
+        };
+        for (size_t i = 0; i < n; ++i)
+            if (numDependencies[i] == 0)
+                launch(i);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]
+                  { return unfinished == 0; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    string ExecutionPlanObj::toString() const
+    {
+        std::ostringstream oss;
+        oss << "ExecutionPlan:\n";
+        for (size_t i = 0; i < steps.size(); ++i)
+            oss << i << ": " << steps[i].kernelName << ", " << steps[i].op
+                << "\n";
+        return oss.str();
+    }
+
+} // namespace infini
@@ -1,17 +1,804 @@
 #include "core/graph.h"
+#include "core/kernel.h"
+#include "core/memory_planner.h"
+#include "core/rewriter.h"
 #include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
 #include <numeric>
 #include <queue>
+#include <tuple>
+#include "operators/concat.h"
 #include "operators/transpose.h"
 #include "operators/matmul.h"
+#include "operators/fused_element_wise.h"
+#include "operators/split.h"
+#include "operators/unary.h"
+#include "utils/operator_utils.h"
 
 namespace infini
 {
 
+    namespace
+    {
+        using Bounds = std::pair<optional<float>, optional<float>>;
+
+        // Make the readers of the output of `chain[0]` read `value`, which
+        // holds the same data, and remove the operators of `chain` left
+        // unread. Each operator of `chain` reads the output of the next one,
+        // the last one reads `value`.
+        bool forward(const OpVec &chain, const Tensor &value,
+                     GraphRewriter &rewriter)
+        {
+            auto output = chain[0]->getOutput();
+            if (!output->getTargets().empty())
+            {
+                rewriter.replaceAllUses(output, value);
+                for (auto &op : chain)
+                    rewriter.eraseIfUnread(op);
+                return true;
+            }
+            // A graph output is written by the producer of `value` instead,
+            // or stays a copy of a graph input.
+            auto source = value->getSource();
+            if (!source || value->getTargets() != OpVec{chain.back()})
+                return false;
+            for (size_t i = 1; i < chain.size(); ++i)
+                if (chain[i]->getOutput()->getTargets() != OpVec{chain[i - 1]})
+                    return false;
+            rewriter.eraseOp(chain[0]);
+            for (size_t i = 1; i < chain.size(); ++i)
+                rewriter.eraseIfUnread(chain[i]);
+            const auto &outputs = source->getOutputs();
+            size_t index =
+                std::find(outputs.begin(), outputs.end(), value) - outputs.begin();
+            rewriter.replaceOutput(source, index, output);
+            return true;
+        }
+
+        // The range a Relu or Clip clamps to.
+        Bounds clampBounds(const Operator &op)
+        {
+            if (auto clip = as<ClipObj>(op))
+                return {clip->getMin(), clip->getMax()};
+            return {0.f, std::nullopt};
+        }
+
+        // The kernels raise to the lower bound first, so a clamp whose range
+        // is inverted always yields its upper bound.
+        Bounds normalizeClamp(const Bounds &bounds)
+        {
+            auto [lo, hi] = bounds;
+            if (lo && hi && *lo > *hi)
+                return {hi, hi};
+            return bounds;
+        }
+
+        // clamp(clamp(x, inner), outer) as a single clamp. Disjoint ranges
+        // give a constant.
+        Bounds composeClamps(const Bounds &inner, const Bounds &outer)
+        {
+            auto [lo1, hi1] = normalizeClamp(inner);
+            auto [lo2, hi2] = normalizeClamp(outer);
+            optional<float> lo = lo1 && lo2 ? std::max(*lo1, *lo2) : lo1 ? lo1 : lo2;
+            optional<float> hi = hi1 && hi2 ? std::min(*hi1, *hi2) : hi1 ? hi1 : hi2;
+            if (lo && hi && *lo > *hi)
+                lo = hi = hi1 && lo2 && *hi1 < *lo2 ? lo2 : hi2;
+            return {lo, hi};
+        }
+
+        // Whether every element of the constant `tensor` equals `value`.
+        bool isFilledWith(const Tensor &tensor, int value)
+        {
+            if (!tensor->isConstant())
+                return false;
+            auto check = [&](auto *ptr)
+            {
+                return std::all_of(ptr, ptr + tensor->size(), [&](auto v)
+                                   { return v == (decltype(v))value; });
+            };
+            const auto dtype = tensor->getDType();
+            if (dtype == DataType::Float32)
+                return check(tensor->getRawDataPtr<float *>());
+            if (dtype == DataType::UInt32)
+                return check(tensor->getRawDataPtr<uint32_t *>());
+            if (dtype == DataType::Int32)
+                return check(tensor->getRawDataPtr<int32_t *>());
+            if (dtype == DataType::Int64)
+                return check(tensor->getRawDataPtr<int64_t *>());
+            return false;
+        }
+
+        // Compose adjacent Transposes, drop identity permutations and fold
+        // swaps of the last two axes into the reading MatMul.
+        vector<RewriteRule> transposeRules()
+        {
+            auto lastTwoAxesSwap = [](const Operator &op)
+            { return is_last_two_axes_swap(as<TransposeObj>(op)->getPermute()); };
+            auto isIdentity = [](const Operator &op)
+            { return is_identity_permutation(as<TransposeObj>(op)->getPermute()); };
+            auto foldIntoMatmul = [](size_t index)
+            {
+                return [index](const OpVec &matched, GraphRewriter &rewriter)
+                {
+                    auto matmul = as<MatmulObj>(matched[0]);
+                    auto transpose = matched[1];
+                    if (index == 0)
+                        matmul->setTransA(!matmul->getTransA());
+                    else
+                        matmul->setTransB(!matmul->getTransB());
+                    // Other readers keep the Transpose alive.
+                    rewriter.replaceInput(matmul, index, transpose->getInputs(0));
+                    rewriter.eraseIfUnread(transpose);
+                    return true;
+                };
+            };
+            return {
+                {"ComposeTransposes",
+                 Pattern::op(OpType::Transpose, {Pattern::op(OpType::Transpose)}),
+                 [](const OpVec &matched, GraphRewriter &rewriter)
+                 {
+                     auto transpose = as<TransposeObj>(matched[0]);
+                     auto prev = as<TransposeObj>(matched[1]);
+                     transpose->setPermute(compose_permutation(
+                         prev->getPermute(), transpose->getPermute()));
+                     rewriter.replaceInput(transpose, 0, prev->getInputs(0));
+                     rewriter.eraseIfUnread(prev);
+                     return true;
+                 }},
+                {"DropIdentityTranspose",
+                 Pattern::op(OpType::Transpose).where(isIdentity),
+                 [](const OpVec &matched, GraphRewriter &rewriter)
+                 { return forward({matched[0]}, matched[0]->getInputs(0), rewriter); }},
+                {"FoldTransposeIntoMatmulA",
+                 Pattern::op(OpType::MatMul,
+                             {Pattern::op(OpType::Transpose).where(lastTwoAxesSwap)}),
+                 foldIntoMatmul(0)},
+                {"FoldTransposeIntoMatmulB",
+                 Pattern::op(OpType::MatMul,
+                             {Pattern::any(),
+                              Pattern::op(OpType::Transpose).where(lastTwoAxesSwap)}),
+                 foldIntoMatmul(1)},
+            };
+        }
+
+        // Move the Transposes feeding an element-wise operator or Concat
+        // below it. A move must strictly reduce the Transpose traffic, so
+        // Transposes are not shuffled around for nothing.
+        RewriteRule sinkTransposeRule()
+        {
+            return {
+                "SinkTransposes",
+                Pattern::op({OpType::Add, OpType::Sub, OpType::Mul, OpType::Div,
+                             OpType::Relu, OpType::Clip, OpType::Concat}),
+                [](const OpVec &matched, GraphRewriter &rewriter)
+                {
+                    auto op = matched[0];
+                    auto concat = as<ConcatObj>(op);
+                    const auto &inputs = op->getInputs();
+                    auto output = op->getOutput();
+                    const size_t rank = output->getRank();
+                    vector<int> perm;
+                    for (auto &input : inputs)
+                        if (auto t = as<TransposeObj>(input->getSource());
+                            t && t->getPermute().size() == rank)
+                        {
+                            perm = t->getPermute();
+                            break;
+                        }
+                    if (perm.empty())
+                        return false;
+
+                    // Transpose traffic before and after the move: the Transposes
+                    // only `op` reads go away, the other full-rank inputs need the
+                    // inverse permutation and the output needs `perm`.
+                    size_t bytesBefore = 0, bytesAfter = 0;
+                    size_t countBefore = 0, countAfter = 0;
+                    OpVec sunk;
+                    TensorVec newInputs;
+                    vector<bool> inverted;
+                    bool movable = true;
+                    for (auto &input : inputs)
+                    {
+                        auto t = as<TransposeObj>(input->getSource());
+                        if (t && t->getPermute() == perm)
+                        {
+                            newInputs.emplace_back(t->getInputs(0));
+                            inverted.push_back(false);
+                            if (std::find(sunk.begin(), sunk.end(), t) != sunk.end())
+                                continue;
+                            sunk.emplace_back(t);
+                            auto targets = input->getTargets();
+                            if (std::all_of(targets.begin(), targets.end(),
+                                            [&](auto &target)
+                                            { return target == op; }))
+                            {
+                                bytesBefore += input->getBytes();
+                                countBefore += 1;
+                            }
+                        }
+                        else if (!concat && input->size() == 1)
+                        {
+                            newInputs.emplace_back(input);
+                            inverted.push_back(false);
+                        }
+                        else if (input->getRank() == rank)
+                        {
+                            newInputs.emplace_back(input);
+                            inverted.push_back(true);
+                            bytesAfter += input->getBytes();
+                            countAfter += 1;
+                        }
+                        else
+                        {
+                            // A lower-rank broadcast would need a reshape.
+                            movable = false;
+                            break;
+                        }
+                    }
+                    // A Transpose moved onto Transposes is merged into them.
+                    auto targets = output->getTargets();
+                    if (targets.empty() ||
+                        !std::all_of(targets.begin(), targets.end(),
+                                     [](auto &target)
+                                     { return target->getOpType() == OpType::Transpose; }))
+                    {
+                        bytesAfter += output->getBytes();
+                        countAfter += 1;
+                    }
+                    if (!movable ||
+                        std::make_pair(bytesAfter, countAfter) >=
+                            std::make_pair(bytesBefore, countBefore))
+                        return false;
+
+                    auto inverse = inverse_permutation(perm);
+                    std::unordered_map<TensorObj *, Tensor> invertedInputs;
+                    for (size_t i = 0; i < newInputs.size(); ++i)
+                    {
+                        auto input = newInputs[i];
+                        if (inverted[i])
+                        {
+                            auto &t = invertedInputs[input.get()];
+                            if (!t)
+                                t = rewriter.create<TransposeObj>(input, nullptr, inverse)
+                                        ->getOutput();
+                            input = t;
+                        }
+                        rewriter.replaceInput(op, i, input);
+                    }
+                    // Output axis j is axis perm[j] before the Transpose.
+                    if (concat)
+                        concat->setDim(perm[concat->getDim()]);
+                    Shape dims(rank);
+                    for (size_t j = 0; j < rank; ++j)
+                        dims[perm[j]] = output->getDims()[j];
+                    auto moved = rewriter.addTensor(dims, output->getDType());
+                    rewriter.replaceOutput(op, 0, moved);
+                    rewriter.createWithOutputs<TransposeObj>(moved, output, perm);
+                    for (auto &t : sunk)
+                        rewriter.eraseIfUnread(t);
+                    return true;
+                }};
+        }
+
+        // Fold a bias Add and Relu/Clip that only read a MatMul output into
+        // the MatMul epilogue.
+        vector<RewriteRule> matmulEpilogueRules()
+        {
+            // The output of `next` becomes the MatMul output.
+            auto absorb = [](const Ref<MatmulObj> &matmul, const Operator &next,
+                             GraphRewriter &rewriter)
+            {
+                rewriter.replaceOutput(matmul, 0, next->getOutput());
+                rewriter.eraseOp(next);
+            };
+            return {
+                {"FoldBiasIntoMatmul",
+                 Pattern::op(OpType::Add,
+                             {Pattern::op(OpType::MatMul).singleUse(), Pattern::any()})
+                     .commutative(),
+                 [absorb](const OpVec &matched, GraphRewriter &rewriter)
+                 {
+                     auto add = matched[0];
+                     auto matmul = as<MatmulObj>(matched[1]);
+                     auto output = matmul->getOutput();
+                     auto epilogue = matmul->getEpilogue();
+                     // The clamp runs after the bias, so an Add can only be
+                     // folded before any activation.
+                     if (!(add->getDType() == output->getDType()) ||
+                         matmul->getBias() || epilogue.min || epilogue.max ||
+                         add->getOutput()->getDims() != output->getDims())
+                         return false;
+                     auto bias = add->getInputs(0) == output ? add->getInputs(1)
+                                                             : add->getInputs(0);
+                     const auto &shape = bias->getDims();
+                     const size_t n = matmul->getN();
+                     if (bias == output || shape.size() > output->getRank() ||
+                         (bias->size() != 1 &&
+                          (bias->size() != n || (size_t)shape.back() != n)))
+                         return false;
+                     rewriter.addInput(matmul, bias);
+                     absorb(matmul, add, rewriter);
+                     return true;
+                 }},
+                {"FoldClampIntoMatmul",
+                 Pattern::op({OpType::Relu, OpType::Clip},
+                             {Pattern::op(OpType::MatMul).singleUse()}),
+                 [absorb](const OpVec &matched, GraphRewriter &rewriter)
+                 {
+                     auto next = matched[0];
+                     auto matmul = as<MatmulObj>(matched[1]);
+                     if (!(next->getDType() == matmul->getOutput()->getDType()))
+                         return false;
+                     auto epilogue = matmul->getEpilogue();
+                     auto [lo, hi] = composeClamps({epilogue.min, epilogue.max},
+                                                   clampBounds(next));
+                     matmul->setEpilogue({lo, hi});
+                     absorb(matmul, next, rewriter);
+                     return true;
+                 }},
+            };
+        }
+
+        // Reassociate chains of MatMuls whose intermediate results have a
+        // single reader, such as (A * B) * C, in the order with the fewest
+        // multiply-adds. This is the classic matrix-chain program over the
+        // m/n/k of the MatMuls.
+        RewriteRule matmulChainRule()
+        {
+            // Whether the output of `matmul` is an inner product of a chain:
+            // a plain MatMul read once, untransposed, by another MatMul.
+            auto isLink = [](const Ref<MatmulObj> &matmul)
+            {
+                auto output = matmul->getOutput();
+                auto targets = output->getTargets();
+                if (matmul->getBias() || matmul->getEpilogue().min ||
+                    matmul->getEpilogue().max || targets.size() != 1)
+                    return false;
+                auto reader = as<MatmulObj>(targets[0]);
+                if (!reader || reader->getInputs(0) == reader->getInputs(1))
+                    return false;
+                return reader->getInputs(0) == output ? !reader->getTransA()
+                                                      : reader->getInputs(1) == output &&
+                                                            !reader->getTransB();
+            };
+            struct Leaf
+            {
+                Tensor tensor;
+                bool trans;
+            };
+            return {
+                "ReorderMatmulChain",
+                Pattern::op(OpType::MatMul).where([=](const Operator &op)
+                                                  { return !isLink(as<MatmulObj>(op)); }),
+                [=](const OpVec &matched, GraphRewriter &rewriter)
+                {
+                    auto root = as<MatmulObj>(matched[0]);
+                    // Collect the operands of the chain from left to right, the
+                    // MatMuls in pre-order and the cost of the current order.
+                    vector<Leaf> leaves;
+                    vector<Ref<MatmulObj>> links;
+                    int64_t current = 0;
+                    std::function<void(const Ref<MatmulObj> &)> flatten =
+                        [&](const Ref<MatmulObj> &matmul)
+                    {
+                        links.emplace_back(matmul);
+                        current += (int64_t)matmul->getM() * matmul->getN() *
+                                   matmul->getK();
+                        for (int i = 0; i < 2; ++i)
+                        {
+                            auto input = matmul->getInputs(i);
+                            auto source = as<MatmulObj>(input->getSource());
+                            if (source && isLink(source))
+                                flatten(source);
+                            else
+                                leaves.push_back(
+                                    {input, i == 0 ? matmul->getTransA()
+                                                   : matmul->getTransB()});
+                        }
+                    };
+                    flatten(root);
+                    const size_t n = leaves.size();
+                    if (n < 3)
+                        return false;
+                    // Every product of the chain has the same batch dims, so
+                    // they only scale the cost.
+                    auto dims = leaves[0].tensor->getDims();
+                    if (dims.size() < 2)
+                        return false;
+                    const Shape batch(dims.begin(), dims.end() - 2);
+                    vector<int64_t> p{dims[dims.size() - (leaves[0].trans ? 1 : 2)]};
+                    for (auto &leaf : leaves)
+                    {
+                        const auto &shape = leaf.tensor->getDims();
+                        if (shape.size() != batch.size() + 2 ||
+                            !std::equal(batch.begin(), batch.end(), shape.begin()) ||
+                            !(leaf.tensor->getDType() == root->getOutput()->getDType()))
+                            return false;
+                        p.emplace_back(shape[shape.size() - (leaf.trans ? 2 : 1)]);
+                    }
+
+                    // cost[i][j] is the cheapest product of leaves i..j and
+                    // split[i][j] the leaf its left factor ends at.
+                    vector<vector<int64_t>> cost(n, vector<int64_t>(n, 0));
+                    vector<vector<size_t>> split(n, vector<size_t>(n, 0));
+                    for (size_t len = 2; len <= n; ++len)
+                        for (size_t i = 0; i + len <= n; ++i)
+                        {
+                            const size_t j = i + len - 1;
+                            cost[i][j] = std::numeric_limits<int64_t>::max();
+                            for (size_t s = i; s < j; ++s)
+                            {
+                                int64_t c = cost[i][s] + cost[s + 1][j] +
+                                            p[i] * p[s + 1] * p[j + 1];
+                                if (c < cost[i][j])
+                                {
+                                    cost[i][j] = c;
+                                    split[i][j] = s;
+                                }
+                            }
+                        }
+                    if (cost[0][n - 1] >= current)
+                        return false;
+
+                    // The leaves are transposed through transA/transB wherever
+                    // they end up, the intermediate results never are.
+                    std::function<Tensor(size_t, size_t, bool)> build =
+                        [&](size_t i, size_t j, bool isRoot)
+                    {
+                        if (i == j)
+                            return leaves[i].tensor;
+                        const size_t s = split[i][j];
+                        auto lhs = build(i, s, false), rhs = build(s + 1, j, false);
+                        bool transA = i == s && leaves[i].trans;
+                        bool transB = s + 1 == j && leaves[j].trans;
+                        if (!isRoot)
+                            return rewriter.create<MatmulObj>(lhs, rhs, nullptr,
+                                                              transA, transB)
+                                ->getOutput();
+                        return rewriter
+                            .create<MatmulObj>(lhs, rhs, nullptr, transA, transB,
+                                               root->getBias(), root->getEpilogue())
+                            ->getOutput();
+                    };
+                    auto product = build(0, n - 1, true);
+                    // The new MatMuls read every leaf before the old ones go.
+                    auto output = root->getOutput();
+                    rewriter.eraseOp(root);
+                    rewriter.replaceOutput(product->getSource(), 0, output);
+                    for (size_t i = 1; i < links.size(); ++i)
+                        rewriter.eraseIfUnread(links[i]);
+                    return true;
+                }};
+        }
+
+        // MatMuls that read the same A with constant B of the same K become
+        // one MatMul over the B concatenated along N. A Split gives every
+        // reader its slice of the wider output.
+        RewriteRule horizontalMatmulRule()
+        {
+            // The concatenated bias is only a row vector if every bias is.
+            auto candidate = [](const Ref<MatmulObj> &matmul)
+            {
+                auto bias = matmul->getBias();
+                return matmul->getInputs(1)->isConstant() &&
+                       (!bias || (bias->isConstant() && bias->getRank() > 0 &&
+                                  bias->getDims().back() == matmul->getN()));
+            };
+            // B without its N axis.
+            auto weightKey = [](const Ref<MatmulObj> &matmul)
+            {
+                auto dims = matmul->getInputs(1)->getDims();
+                dims[dims.size() - (matmul->getTransB() ? 2 : 1)] = 0;
+                return dims;
+            };
+            // Whether `a` and `b` only differ in N.
+            auto fusible = [=](const Ref<MatmulObj> &a, const Ref<MatmulObj> &b)
+            {
+                auto biasA = a->getBias(), biasB = b->getBias();
+                const auto &epilogueA = a->getEpilogue();
+                const auto &epilogueB = b->getEpilogue();
+                return a->getInputs(0) == b->getInputs(0) &&
+                       a->getTransA() == b->getTransA() &&
+                       a->getTransB() == b->getTransB() &&
+                       a->getInputs(1)->getDType() == b->getInputs(1)->getDType() &&
+                       weightKey(a) == weightKey(b) && !biasA == !biasB &&
+                       (!biasA || biasA->getRank() == biasB->getRank()) &&
+                       epilogueA.min == epilogueB.min &&
+                       epilogueA.max == epilogueB.max;
+            };
+            return {"FuseHorizontalMatmuls",
+                    Pattern::op(OpType::MatMul).where([=](const Operator &op)
+                                                      { return candidate(as<MatmulObj>(op)); }),
+                    [=](const OpVec &matched, GraphRewriter &rewriter)
+                    {
+                        auto matmul = as<MatmulObj>(matched[0]);
+                        vector<Ref<MatmulObj>> group;
+                        for (auto &target : matmul->getInputs(0)->getTargets())
+                        {
+                            auto other = as<MatmulObj>(target);
+                            if (other && candidate(other) && fusible(matmul, other) &&
+                                std::find(group.begin(), group.end(), other) ==
+                                    group.end())
+                                group.emplace_back(other);
+                        }
+                        if (group.size() < 2)
+                            return false;
+                        TensorVec weights, biases, outputs;
+                        vector<int> sizes;
+                        for (auto &member : group)
+                        {
+                            weights.emplace_back(member->getInputs(1));
+                            if (auto bias = member->getBias())
+                                biases.emplace_back(bias);
+                            outputs.emplace_back(member->getOutput());
+                            sizes.emplace_back(member->getN());
+                        }
+                        // The Concats only read constants and are folded after
+                        // the pass.
+                        const int rank = weights[0]->getRank();
+                        auto weight = rewriter
+                                          .create<ConcatObj>(weights, nullptr,
+                                                             matmul->getTransB() ? rank - 2
+                                                                                 : rank - 1)
+                                          ->getOutput();
+                        Tensor bias =
+                            biases.empty()
+                                ? nullptr
+                                : rewriter.create<ConcatObj>(biases, nullptr, -1)->getOutput();
+                        auto fused = rewriter.create<MatmulObj>(
+                            matmul->getInputs(0), weight, nullptr, matmul->getTransA(),
+                            matmul->getTransB(), bias, matmul->getEpilogue());
+                        for (auto &member : group)
+                            rewriter.eraseOp(member);
+                        rewriter.createWithOutputs<SplitObj>(fused->getOutput(),
+                                                             outputs, -1, sizes);
+                        return true;
+                    }};
+        }
+
+        // Remove operators that copy their input and merge chains of clamps.
+        // Cast round trips through a narrower type are only removed if
+        // `allowPrecisionLoss` is set.
+        vector<RewriteRule> algebraicRules(bool allowPrecisionLoss)
+        {
+            auto forwardInput = [](const OpVec &matched, GraphRewriter &rewriter)
+            { return forward({matched[0]}, matched[0]->getInputs(0), rewriter); };
+            // x + 0, x - 0, x * 1 and x / 1, when x has the output shape.
+            auto identityOperand = [](int value, bool commutative)
+            {
+                return [=](const OpVec &matched, GraphRewriter &rewriter)
+                {
+                    auto op = matched[0];
+                    auto output = op->getOutput();
+                    for (int i = 1; i >= (commutative ? 0 : 1); --i)
+                    {
+                        auto x = op->getInputs(1 - i);
+                        if (isFilledWith(op->getInputs(i), value) &&
+                            x->getDims() == output->getDims() &&
+                            x->getDType() == output->getDType())
+                            return forward({op}, x, rewriter);
+                    }
+                    return false;
+                };
+            };
+            return {
+                {"DropFloat2FloatCast",
+                 Pattern::op(OpType::Cast).where([](const Operator &op)
+                                                 { return as<CastObj>(op)->getType() ==
+                                                          CastType::Float2Float; }),
+                 forwardInput},
+                {"DropCastRoundTrip",
+                 Pattern::op(OpType::Cast, {Pattern::op(OpType::Cast)}),
+                 [allowPrecisionLoss](const OpVec &matched, GraphRewriter &rewriter)
+                 {
+                     auto inner = matched[1];
+                     auto x = inner->getInputs(0);
+                     auto from = x->getDType(), via = inner->getOutput()->getDType();
+                     // Only rounding to a half-precision float may be
+                     // dropped; integer types saturate or truncate.
+                     bool rounds = (from == DataType::Float32 ||
+                                    from == DataType::Double) &&
+                                   (via == DataType::Float16 ||
+                                    via == DataType::BFloat16);
+                     if (!(from == matched[0]->getOutput()->getDType()) ||
+                         !((allowPrecisionLoss && rounds) ||
+                           is_exact_conversion(from, via)))
+                         return false;
+                     return forward(matched, x, rewriter);
+                 }},
+                {"DropUnboundedClip",
+                 Pattern::op(OpType::Clip).where([](const Operator &op)
+                                                 { return !as<ClipObj>(op)->getMin() &&
+                                                          !as<ClipObj>(op)->getMax(); }),
+                 forwardInput},
+                {"DropReluOfRelu",
+                 Pattern::op(OpType::Relu, {Pattern::op(OpType::Relu)}),
+                 forwardInput},
+                {"MergeClamps",
+                 Pattern::op({OpType::Relu, OpType::Clip},
+                             {Pattern::op({OpType::Relu, OpType::Clip}).singleUse()}),
+                 [](const OpVec &matched, GraphRewriter &rewriter)
+                 {
+                     auto outer = matched[0], inner = matched[1];
+                     auto [lo, hi] =
+                         composeClamps(clampBounds(inner), clampBounds(outer));
+                     auto input = inner->getInputs(0), output = outer->getOutput();
+                     rewriter.eraseOp(outer);
+                     rewriter.createWithOutputs<ClipObj>(input, output, lo, hi);
+                     rewriter.eraseIfUnread(inner);
+                     return true;
+                 }},
+                {"DropAddZero",
+                 Pattern::op(OpType::Add, {Pattern::any(), Pattern::any()}),
+                 identityOperand(0, true)},
+                {"DropSubZero",
+                 Pattern::op(OpType::Sub, {Pattern::any(), Pattern::any()}),
+                 identityOperand(0, false)},
+                {"DropMulOne",
+                 Pattern::op(OpType::Mul, {Pattern::any(), Pattern::any()}),
+                 identityOperand(1, true)},
+                {"DropDivOne",
+                 Pattern::op(OpType::Div, {Pattern::any(), Pattern::any()}),
+                 identityOperand(1, false)},
+                {"DropSingleInputConcat",
+                 Pattern::op(OpType::Concat).where([](const Operator &op)
+                                                   { return op->getInputs().size() == 1; }),
+                 forwardInput},
+            };
+        }
+
+        // Orders `ops`, already in topological order, so that the bytes of
+        // live non-constant tensors peak as low as possible. A tensor is live
+        // from its producer, or the start for graph inputs, until its last
+        // reader has run; graph outputs stay live to the end.
+        OpVec minMemoryOrder(const OpVec &ops, size_t exactLimit)
+        {
+            const size_t n = ops.size();
+            std::unordered_map<OperatorObj *, size_t> index;
+            for (size_t i = 0; i < n; ++i)
+                index[ops[i].get()] = i;
+            // Per operator: its predecessors, the bytes of its outputs, and
+            // the distinct non-constant tensors it reads.
+            vector<vector<size_t>> preds(n);
+            vector<size_t> outBytes(n, 0);
+            vector<TensorVec> reads(n);
+            std::unordered_map<TensorObj *, vector<size_t>> readers;
+            size_t initial = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                for (auto &pred : ops[i]->getPredecessors())
+                    preds[i].emplace_back(index.at(pred.get()));
+                for (auto &output : ops[i]->getOutputs())
+                    outBytes[i] += output->getBytes();
+                for (auto &input : ops[i]->getInputs())
+                {
+                    if (input->isConstant() ||
+                        std::find(reads[i].begin(), reads[i].end(), input) !=
+                            reads[i].end())
+                        continue;
+                    reads[i].emplace_back(input);
+                    auto [it, inserted] = readers.try_emplace(input.get());
+                    if (inserted && !input->getSource())
+                        initial += input->getBytes();
+                    it->second.emplace_back(i);
+                }
+            }
+
+            // The tables below hold 2^n entries each.
+            if (n <= std::min(exactLimit, GraphObj::maxExactSchedule))
+            {
+                // Dynamic program over the sets of operators already run: the
+                // live bytes only depend on the set, the peak on the path.
+                using Mask = uint32_t;
+                const Mask all = (Mask(1) << n) - 1;
+                vector<Mask> predMask(n, 0);
+                for (size_t i = 0; i < n; ++i)
+                    for (auto p : preds[i])
+                        predMask[i] |= Mask(1) << p;
+                std::unordered_map<TensorObj *, Mask> readerMask;
+                for (auto &[tensor, list] : readers)
+                    for (auto r : list)
+                        readerMask[tensor] |= Mask(1) << r;
+                vector<size_t> peak(size_t(all) + 1, SIZE_MAX),
+                    live(size_t(all) + 1, 0);
+                vector<int> last(size_t(all) + 1, -1);
+                peak[0] = live[0] = initial;
+                // Adding an operator only sets a bit, so every set is
+                // complete before it is expanded.
+                for (Mask mask = 0; mask < all; ++mask)
+                {
+                    if (peak[mask] == SIZE_MAX)
+                        continue;
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        const Mask bit = Mask(1) << i;
+                        if ((mask & bit) || (predMask[i] & ~mask))
+                            continue;
+                        const Mask next = mask | bit;
+                        size_t nextLive = live[mask] + outBytes[i];
+                        size_t nextPeak = std::max(peak[mask], nextLive);
+                        for (auto &input : reads[i])
+                            if ((readerMask[input.get()] & ~next) == 0)
+                                nextLive -= input->getBytes();
+                        if (nextPeak < peak[next])
+                        {
+                            peak[next] = nextPeak;
+                            live[next] = nextLive;
+                            last[next] = i;
+                        }
+                    }
+                }
+                OpVec order(n);
+                for (Mask mask = all; mask; mask &= ~(Mask(1) << last[mask]))
+                    order[__builtin_popcount(mask) - 1] = ops[last[mask]];
+                return order;
+            }
+
+            // Greedy: run the ready operator that frees the most bytes net of
+            // its outputs; on a tie the one with the smaller outputs, which
+            // peaks lower while it runs, then the earlier one.
+            vector<size_t> waiting(n);
+            std::unordered_map<TensorObj *, size_t> left;
+            for (auto &[tensor, list] : readers)
+                left[tensor] = list.size();
+            for (size_t i = 0; i < n; ++i)
+                waiting[i] = preds[i].size();
+            vector<vector<size_t>> succs(n);
+            for (size_t i = 0; i < n; ++i)
+                for (auto p : preds[i])
+                    succs[p].emplace_back(i);
+            vector<bool> done(n, false);
+            auto delta = [&](size_t i)
+            {
+                size_t freed = 0;
+                for (auto &input : reads[i])
+                    if (left[input.get()] == 1)
+                        freed += input->getBytes();
+                return (int64_t)outBytes[i] - (int64_t)freed;
+            };
+            // A delta only falls as other readers run, and the operator is
+            // pushed again when it does, so entries whose delta has changed
+            // are stale.
+            using Entry = std::tuple<int64_t, size_t, size_t>;
+            std::priority_queue<Entry, vector<Entry>, std::greater<Entry>> ready;
+            auto push = [&](size_t i)
+            { ready.emplace(delta(i), outBytes[i], i); };
+            for (size_t i = 0; i < n; ++i)
+                if (!waiting[i])
+                    push(i);
+            OpVec order;
+            while (order.size() < n)
+            {
+                auto [d, bytes, best] = ready.top();
+                ready.pop();
+                if (done[best] || d != delta(best))
+                    continue;
+                done[best] = true;
+                order.emplace_back(ops[best]);
+                for (auto &input : reads[best])
+                    if (--left[input.get()] == 1)
+                        for (auto r : readers[input.get()])
+                            if (!done[r] && !waiting[r])
+                                push(r);
+                for (auto s : succs[best])
+                    if (--waiting[s] == 0)
+                        push(s);
+            }
+            return order;
+        }
+    } // namespace
+
     void GraphObj::addOperatorAndConnect(const Operator &op)
     {
-        sorted = false;
+        // Appended last, the operator only breaks the order if its outputs
+        // already have readers.
+        invalidatePlan();
+        position[op.get()] = ops.size();
         ops.push_back(op);
+        if (schedule != Schedule::Insertion)
+            sorted = false;
         for (auto &input : op->getInputs())
         {
             if (input)
@@ -33,13 +820,45 @@ namespace infini
                 {
                     succ->addPredecessors(op);
                     op->addSuccessors(succ);
+                    orderEdge(op, succ);
                 }
             }
         }
     }
 
+    void GraphObj::removeOperatorAndDisconnect(const Operator &op)
+    {
+        for (auto &input : op->getInputs())
+        {
+            if (input)
+            {
+                input->removeTarget(op);
+                if (auto pred = input->getSource())
+                {
+                    pred->removeSuccessors(op);
+                    op->removePredecessors(pred);
+                }
+            }
+        }
+        for (auto &output : op->getOutputs())
+        {
+            if (output)
+            {
+                if (output->getSource() == op)
+                    output->setSource(nullptr);
+                for (auto &succ : output->getTargets())
+                {
+                    succ->removePredecessors(op);
+                    op->removeSuccessors(succ);
+                }
+            }
+        }
+        removeOperator(op);
+    }
+
     string GraphObj::toString() const
     {
+        compact();
     //    std::cout << "GraphObj begins: " << std::endl; 
         std::ostringstream oss;
         oss << "Graph Tensors:\n";
@@ -77,48 +896,71 @@ namespace infini
 
     bool GraphObj::topo_sort()
     {
+        compact();
         if (this->sorted)
         {
             return true;
         }
-        std::vector<Operator> sorted;
-        std::unordered_set<OperatorObj *> flags;
+        // Kahn's algorithm: an operator is ready once the producers of all
+        // its inputs have run. Ready operators keep their insertion order.
+        std::unordered_map<OperatorObj *, size_t> waiting;
+        waiting.reserve(ops.size());
+        std::deque<Operator> ready;
+        for (auto &op : ops)
+        {
+            size_t count = 0;
+            for (auto &input : op->getInputs())
+                if (input && input->getSource())
+                    ++count;
+            waiting[op.get()] = count;
+            if (count == 0)
+                ready.emplace_back(op);
+        }
+        OpVec sorted;
         sorted.reserve(ops.size());
-        flags.reserve(ops.size());
-        while (sorted.size() < ops.size())
+        while (!ready.empty())
         {
-            // Any node is move to sorted in this loop.
-            auto modified = false;
-            for (auto const &op : ops)
-            {
-                if (auto const &inputs = op->getInputs();
-                    flags.find(op.get()) == flags.end() &&
-                    std::all_of(inputs.begin(), inputs.end(),
-                                [&flags](auto const &input)
-                                {
-                                    auto ptr = input->getSource().get();
-                                    return !ptr || flags.find(ptr) != flags.end();
-                                }))
+            auto op = ready.front();
+            ready.pop_front();
+            sorted.emplace_back(op);
+            // Every target entry stands for one input of its reader.
+            for (auto &output : op->getOutputs())
+                for (auto &target : output->getTargets())
                 {
-                    modified = true;
-                    sorted.emplace_back(op);
-                    flags.insert(op.get());
+                    auto it = waiting.find(target.get());
+                    if (it != waiting.end() && --it->second == 0)
+                        ready.emplace_back(target);
                 }
-            }
-            if (!modified)
-            {
-                return false;
-            }
         }
+        // The rest is on a cycle or reads an operator outside the graph.
+        if (sorted.size() < ops.size())
+            return false;
         this->ops = std::move(sorted);
+        if (schedule == Schedule::MinMemory)
+            this->ops = minMemoryOrder(this->ops, exactScheduleLimit);
+        for (size_t i = 0; i < this->ops.size(); ++i)
+            position[this->ops[i].get()] = i;
+        invalidatePlan();
         return this->sorted = true;
     }
 
+    void GraphObj::orderEdge(const Operator &from, const Operator &to)
+    {
+        if (!sorted)
+            return;
+        // Any edit may change the best MinMemory order.
+        auto src = position.find(from.get()), dst = position.find(to.get());
+        if (schedule != Schedule::Insertion || src == position.end() ||
+            dst == position.end() || src->second >= dst->second)
+            sorted = false;
+    }
+
     void GraphObj::deleteConnection(Tensor tensor, Operator op) {
         // if op is target
         IT_ASSERT(std::find(tensor->getTargets().begin(),
                             tensor->getTargets().end(),
                             op) != tensor->getTargets().end());
+        invalidatePlan();
         tensor->removeTarget(op);
         if (tensor->getSource()) {
             tensor->getSource()->removeSuccessors(op);
@@ -128,224 +970,306 @@ namespace infini
     
     // add op as a target
     void GraphObj::addConnection(Tensor tensor, Operator op) {
+        invalidatePlan();
         tensor->addTarget(op);
         if (tensor->getSource()) {
             tensor->getSource()->addSuccessors(op);
             op->addPredecessors(tensor->getSource());
+            orderEdge(tensor->getSource(), op);
         }
     }
 
-    void GraphObj::optimize()
+    void GraphObj::replaceInput(const Operator &op, size_t index,
+                                const Tensor &tensor)
     {
-        // =================================== 作业 ===================================
-        // TODO: 设计一个算法来实现指定的图优化规则
-        // 图优化规则如下：
-        // 1. 去除冗余的算子（例如，两个相邻的算子都是 transpose 算子，且做的是相反的操作，可以将其全部删除）
-        // 2. 合并算子（例如，矩阵乘算子中含有属性transA、transB，如果其输入存在transpose，且对最后两个维度做交换，就可以将transpose融入到矩阵乘算子的属性中去）
-        // =================================== 作业 ===================================
-        
-        // 遍历所有操作符
-        int iter = 0;
-        for (auto it = ops.begin(); it != ops.end();) {
-    //        std::cout << "Here-2: " << ops.size() << std::endl;
-            iter += 1;
-    //        std::cout << "Here-1: " << iter << std::endl;
-            auto op = *it;
-    //        std::cout << "Here-0.9: " << iter << std::endl;
-            if(!op){
-                ++it;
-    //            std::cout << "Here-0.8: " << iter << std::endl;
-                continue;
+        auto old = op->getInputs(index);
+        if (old == tensor)
+            return;
+        // Edges are not counted per input, so drop every edge between `old`
+        // and `op` and add back those still backed by another input.
+        deleteConnection(old, op);
+        op->inputs[index] = tensor;
+        auto source = old->getSource();
+        for (auto &input : op->getInputs())
+        {
+            if (input == old)
+                addConnection(old, op);
+            else if (source && input != tensor && input->getSource() == source)
+            {
+                source->addSuccessors(op);
+                op->addPredecessors(source);
             }
-    //        std::cout << "Here-0.5: " << iter << std::endl;
-            OpType::underlying_t opType = op->getOpType().underlying();
-    //        std::cout << "Here0: " << iter << std::endl;
-            switch (opType) {
-                case OpType::Transpose: {
-                    // 获取当前操作符的后继操作符
-                    auto nextops = op->getSuccessors();
-    //                std::cout << "Here: " << iter << std::endl;
-                    if (!nextops.empty() && nextops[0]->getOpType().underlying() == OpType::Transpose) {
-                        // 使用 std::dynamic_pointer_cast 进行类型转换
-                        auto transposeOp = std::dynamic_pointer_cast<TransposeObj>(op);  // 转换为 shared_ptr<TransposeObj>
-                        auto nextTransposeOp = std::dynamic_pointer_cast<TransposeObj>(nextops[0]);
-    //                    std::cout << "Here1: " << iter << std::endl;
-                        if (transposeOp && nextTransposeOp && transposeOp->getPermute() == nextTransposeOp->getPermute()) {
-                            // transpose 只有一个输入
-                            auto input = transposeOp->getInputs()[0];
-    //                        std::cout << "Here1.5: " << input->getGuid() << std::endl;
-                            // 获取第二个 transpose 的输入
-                            auto input2 = nextTransposeOp->getInputs()[0];                            
-
-                            // 获取第二个 transpose 的输出
-                            auto output = nextTransposeOp->getOutput();
-                            
-                            removeTensor(input2);
-                            removeTensor(output);
-
-                            // 获取第一个 transpose 的前驱操作符
-                            auto predecessors_all = transposeOp->getPredecessors();
-                            if (!predecessors_all.empty()) {
-                                auto predecessor_all = predecessors_all[0];
-                                predecessor_all->removeSuccessors(transposeOp);  // 删除前驱与第一个 transpose 的连接
-                            }
+        }
+        addConnection(tensor, op);
+    }
 
-    //                        std::cout << "Here2: " << iter << std::endl;
-                            // 移除当前的 op 连接
-                            deleteConnection(input, transposeOp);
-    //                        std::cout << "Here3: " << iter << std::endl;
-
-                            // 连接新的操作符（下一个 transpose 操作的后继）
-                            auto nextnextop = nextTransposeOp->getSuccessors();
-                            if (!nextnextop.empty()) {
-                                addConnection(input, nextnextop[0]);  // 连接第一个 transpose 的输入到第二个 transpose 的后继
-                                nextnextop[0]->replaceInput(output, input);
-                                nextnextop[0]->removePredecessors(nextTransposeOp);  // 删除第二个 transpose 的前驱
-
-                                if (!predecessors_all.empty()) {
-                                    // 连接前驱到新的后继
-                                    auto predecessor_all = predecessors_all[0];
-                                    predecessor_all->addSuccessors(nextnextop[0]);  // 连接前驱到新的后继
-                                    nextnextop[0]->addPredecessors(predecessor_all);  // 将前驱作为新的后继的前驱
-                                }
-                            }
-    //                        std::cout << "Here3.5: " << input->getGuid() << std::endl;
-    //                        std::cout << "Here4: " << iter << std::endl;
-                            // 删除当前和下一个操作符
-                            it = ops.erase(it);  // 删除当前的 op，it 会指向下一个元素
-                            if (it != ops.end()) {
-                                it = ops.erase(it);  // 删除下一个操作符，it 会指向下一个元素
-                            }
-    //                        std::cout << "Here5: " << iter << std::endl;
-    //                        std::cout << "Here6: " << ops.size() << std::endl;
-                            continue;  // 跳过当前迭代，避免重复处理已经删除的操作符
-                        }
-                    }
-                    break;
-                }
-                // 处理其他操作符（例如 Conv, MatMul 等）
-                // case OpType::Conv: { ... }
-                // case OpType::MatMul: { ... }
-                
-                case OpType::MatMul: {
-                    // 获取当前操作符的输入
-                    auto inputs = op->getInputs();
-    //                std::cout << "Matmul Here-0.5: " << op->getInputs(0)->getGuid() << std::endl;
-                    int freq = 0;
-
-    //                std::cout << "Matmul Here0: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                    // 遍历所有输入，检查每个输入是否为 Transpose 操作
-                    for (auto &input : inputs) {
-                        // 获取当前输入的前驱操作符
-                        auto predecessor = input->getSource();
-    //                    std::cout << "Matmul Here1: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-    //                    std::cout << "Matmul Here1.5: " << "Guid: " << input->getGuid() << ", ops.size: " << ops.size() << std::endl;
-                        // 检查前驱是否为空
-                        if (predecessor) {
-    //                        std::cout << "Matmul Here2: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                            // 如果前驱是 Transpose 操作
-                            if (predecessor->getOpType().underlying() == OpType::Transpose) {
-    //                            std::cout << "Matmul Here3: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                // 转换为 TransposeObj 类型
-                                auto transposeOp = std::dynamic_pointer_cast<TransposeObj>(predecessor);
-                                if (transposeOp) {
-    //                                std::cout << "Matmul Here4: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                    // 如果 transpose 对最后两个维度进行了交换
-                                    auto permute = transposeOp->getPermute();
-    //                                std::cout << "Matmul Here4.5: " << "freq: " << freq << ", permute.size: " << permute.size() << std::endl;
-                                    if (permute[2] == 3 && permute[3] == 2) {
-                                        // 获取 Matmul 操作
-                                        auto matmulOp = std::dynamic_pointer_cast<MatmulObj>(op);
-    //                                    std::cout << "Matmul Here5: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                        if (matmulOp) {
-                                            if (freq == 0) {
-                                                // 第一个输入对应 Transpose 操作，调整 transA
-                                                matmulOp->setTransA(!matmulOp->getTransA());
-                                            } else if (freq == 1) {
-                                                // 第二个输入对应 Transpose 操作，调整 transB
-                                                matmulOp->setTransB(!matmulOp->getTransB());
-                                            }
-    //                                        std::cout << "Matmul Here6: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            // 删除matmul op和其transpose分支上的输入连接
-                                            deleteConnection(transposeOp->getOutput(), matmulOp);
-    //                                        std::cout << "Matmul Here7: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            // 删除matmul op的transpose分支的输入
-                                            removeTensor(input);
-    //                                        std::cout << "Matmul Here8: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            // 新建matmul op在原有tranpose分支的输入及连接（不知道要不要插入到原有位置）
-                                            auto transpose_input = transposeOp->getInputs()[0];
-                                            auto transpose_output = transposeOp->getOutput();
-    //                                        std::cout << "Matmul Here9: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            matmulOp->inputs.emplace_back(transpose_input);
-    //                                        std::cout << "Matmul Here10: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            transpose_output->removeTarget(matmulOp);
-    //                                        std::cout << "Matmul Here11: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            deleteConnection(transpose_input, transposeOp);
-    //                                        std::cout << "Matmul Here12: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            addConnection(transpose_input, matmulOp);
-    //                                        std::cout << "Matmul Here13: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            //deleteConnection(transpose_output, transposeOp);
-                                            //transpose_outputtranspose_output->getSource(transposeOp);
-                                            matmulOp->replaceInput(input, transpose_input);
-    //                                        std::cout << "Matmul Here14: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                                            // 更新matmul op的op list
-
-                                            // 如果transposeOp有前驱操作符，需要更新前驱的后继关系
-                                            auto predecessors = transposeOp->getPredecessors();
-                                            for (auto &predecessor : predecessors) {
-                                                // 更新前驱的后继指向matmulOp
-                                                matmulOp->addPredecessors(predecessor); 
-                                                predecessor->addPredecessors(matmulOp);
-                                            } 
-                                            
-    //                                        std::cout << "Matmul Here15: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-
-                                            // 删除 transposeOp
-                                            auto it_to_remove = std::find(ops.begin(), ops.end(), transposeOp);
-                                            it = ops.erase(it_to_remove);
-                                            it = std::find(ops.begin(), ops.end(), op);
-                                            
-    //                                        std::cout << "Matmul Here16: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        freq += 1;
-    //                    std::cout << "Matmul Here17: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                    }
-    //                std::cout << "Matmul Here18: " << "freq: " << freq << ", ops.size: " << ops.size() << std::endl;
-                    //++it;
-                    break;
-                }
+    void GraphObj::addInput(const Operator &op, const Tensor &tensor)
+    {
+        op->inputs.emplace_back(tensor);
+        addConnection(tensor, op);
+    }
 
-                default:
-                    ++it;
-                    break;
+    void GraphObj::replaceOutput(const Operator &op, size_t index,
+                                 const Tensor &tensor)
+    {
+        invalidatePlan();
+        auto old = op->getOutputs()[index];
+        for (auto &succ : old->getTargets())
+        {
+            succ->removePredecessors(op);
+            op->removeSuccessors(succ);
+        }
+        if (old->getSource() == op)
+            old->setSource(nullptr);
+        op->outputs[index] = tensor;
+        tensor->setSource(op);
+        for (auto &succ : tensor->getTargets())
+        {
+            succ->addPredecessors(op);
+            op->addSuccessors(succ);
+            orderEdge(op, succ);
+        }
+    }
+
+    void GraphObj::replaceAllUses(const Tensor &from, const Tensor &to)
+    {
+        for (auto &target : from->getTargets())
+        {
+            const auto &inputs = target->getInputs();
+            for (size_t i = 0; i < inputs.size(); ++i)
+                if (inputs[i] == from)
+                    replaceInput(target, i, to);
+        }
+    }
+
+    void GraphObj::simplifyAlgebra(bool allowPrecisionLoss)
+    {
+        GraphRewriter(*this).apply(algebraicRules(allowPrecisionLoss));
+    }
+
+    void GraphObj::optimize(bool allowPrecisionLoss)
+    {
+        foldConstants();
+        eliminateCommonSubexpressions();
+        // The simplification, layout and epilogue rules share one fixpoint,
+        // so a rewrite by one of them can enable the others.
+        auto rules = algebraicRules(allowPrecisionLoss);
+        for (auto &rule : transposeRules())
+            rules.emplace_back(rule);
+        rules.emplace_back(sinkTransposeRule());
+        rules.emplace_back(matmulChainRule());
+        for (auto &rule : matmulEpilogueRules())
+            rules.emplace_back(rule);
+        GraphRewriter(*this).apply(rules);
+        fuseHorizontalMatmuls();
+        fuseElementWise();
+    }
+
+    void GraphObj::foldConstants()
+    {
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        // A graph output keeps its producer.
+        auto foldable = [](const Operator &op)
+        {
+            const auto &inputs = op->getInputs();
+            const auto &outputs = op->getOutputs();
+            return !inputs.empty() &&
+                   std::all_of(inputs.begin(), inputs.end(),
+                               [](auto &input)
+                               { return input->isConstant(); }) &&
+                   std::none_of(outputs.begin(), outputs.end(),
+                                [](auto &output)
+                                { return output->getTargets().empty(); });
+        };
+        GraphRewriter(*this).apply(
+            {{"FoldConstants", Pattern::op({}).where(foldable),
+              [&](const OpVec &matched, GraphRewriter &rewriter)
+              {
+                  auto op = matched[0];
+                  for (auto &output : op->getOutputs())
+                      bindConstant(output);
+                  auto kernelAttrs = KernelAttrs{runtime->getDevice(),
+                                                 op->getOpType().underlying()};
+                  kernelRegistry.getKernel(kernelAttrs)->compute(op,
+                                                                 runtime.get());
+                  // Constants only `op` read are dropped with their memory.
+                  rewriter.eraseOp(op);
+                  return true;
+              }}});
+    }
+
+    void GraphObj::eliminateCommonSubexpressions()
+    {
+        IT_ASSERT(topo_sort() == true);
+        struct KeyHash
+        {
+            size_t operator()(const vector<int> &key) const
+            {
+                size_t seed = key.size();
+                for (int v : key)
+                    seed ^= std::hash<int>()(v) + 0x9e3779b9 + (seed << 6) +
+                            (seed >> 2);
+                return seed;
+            }
+        };
+        // Keyed by the attribute count, the attributes and the input guids.
+        // In topological order the inputs of an operator are merged before
+        // it is looked up.
+        std::unordered_map<vector<int>, Operator, KeyHash> seen;
+        for (auto &op : OpVec(ops))
+        {
+            auto attrs = op->getOpAttrVector();
+            vector<int> key{(int)attrs.size()};
+            key.insert(key.end(), attrs.begin(), attrs.end());
+            for (auto &input : op->getInputs())
+                key.emplace_back(input->getGuid());
+            auto [it, inserted] = seen.try_emplace(key, op);
+            if (inserted)
+                continue;
+            const auto &outputs = op->getOutputs();
+            const auto &kept = it->second->getOutputs();
+            // A graph output can neither be rewired to another tensor nor
+            // gain readers, which would turn it into an intermediate.
+            auto isGraphOutput = [](auto &output)
+            { return output->getTargets().empty(); };
+            if (outputs.size() != kept.size() ||
+                std::any_of(outputs.begin(), outputs.end(), isGraphOutput) ||
+                std::any_of(kept.begin(), kept.end(), isGraphOutput))
+                continue;
+            bool same = true;
+            for (size_t i = 0; i < outputs.size(); ++i)
+                same &= outputs[i]->getDims() == kept[i]->getDims() &&
+                        outputs[i]->getDType() == kept[i]->getDType();
+            if (!same)
+                continue;
+            for (size_t i = 0; i < outputs.size(); ++i)
+            {
+                replaceAllUses(outputs[i], kept[i]);
+                removeTensor(outputs[i]);
             }
-    //        std::cout << "Here19: " << ", ops.size: " << ops.size() << std::endl;
-            // 如果没有删除操作符，则手动增加迭代器
-            ++it;
-    //        std::cout << "Here20: " << ", ops.size: " << ops.size() << std::endl;
-        } 
-    //    std::cout << "Here21: " << ", ops.size: " << ops.size() << std::endl;
+            removeOperatorAndDisconnect(op);
+        }
+        IT_ASSERT(topo_sort() == true);
     }
 
-    Tensor GraphObj::getTensor(int fuid) const
+    void GraphObj::simplifyTransposes()
     {
-        for (auto tensor : tensors)
+        GraphRewriter(*this).apply(transposeRules());
+    }
+
+    void GraphObj::sinkTransposes()
+    {
+        auto rules = transposeRules();
+        rules.emplace_back(sinkTransposeRule());
+        GraphRewriter(*this).apply(rules);
+    }
+
+    void GraphObj::fuseMatmulEpilogue()
+    {
+        GraphRewriter(*this).apply(matmulEpilogueRules());
+    }
+
+    void GraphObj::reorderMatmulChains()
+    {
+        GraphRewriter(*this).apply({matmulChainRule()});
+    }
+
+    void GraphObj::fuseHorizontalMatmuls()
+    {
+        if (GraphRewriter(*this).apply({horizontalMatmulRule()}))
+            foldConstants();
+    }
+
+    void GraphObj::fuseElementWise()
+    {
+        IT_ASSERT(topo_sort() == true);
+        using Instruction = FusedElementWiseObj::Instruction;
+        auto fusible = [](const Operator &op)
+        { return FusedElementWiseObj::isFusible(op->getOpType()); };
+        // An element-wise op is folded into its consumer when that consumer
+        // is element-wise as well and the only reader of its output.
+        auto absorbed = [&](const Operator &op)
+        {
+            if (!fusible(op))
+                return false;
+            auto targets = op->getOutput()->getTargets();
+            return !targets.empty() && fusible(targets[0]) &&
+                   targets[0]->getDType() == op->getDType() &&
+                   std::all_of(targets.begin(), targets.end(),
+                               [&](auto &t)
+                               { return t == targets[0]; });
+        };
+
+        OpVec roots;
+        for (auto it = ops.rbegin(); it != ops.rend(); ++it)
+            if (fusible(*it) && !absorbed(*it))
+                roots.emplace_back(*it);
+
+        for (auto &root : roots)
         {
-            if (tensor->getFuid() == fuid)
+            // Collect the tree in post-order, so every member comes after
+            // the members producing its inputs.
+            OpVec members;
+            TensorVec leaves;
+            std::function<void(const Operator &)> visit = [&](const Operator &op)
             {
-                return tensor;
+                for (auto &input : op->getInputs())
+                {
+                    auto source = input->getSource();
+                    if (source && absorbed(source))
+                    {
+                        if (std::find(members.begin(), members.end(), source) ==
+                            members.end())
+                            visit(source);
+                    }
+                    else if (std::find(leaves.begin(), leaves.end(), input) ==
+                             leaves.end())
+                        leaves.emplace_back(input);
+                }
+                members.emplace_back(op);
+            };
+            visit(root);
+            if (members.size() < 2)
+                continue;
+
+            std::unordered_map<TensorObj *, int> valueOf;
+            for (size_t i = 0; i < leaves.size(); ++i)
+                valueOf[leaves[i].get()] = i;
+            vector<Instruction> program;
+            for (auto &op : members)
+            {
+                Instruction instr{op->getOpType(),
+                                  valueOf.at(op->getInputs(0).get()), -1, {}, {}};
+                if (op->getInputs().size() == 2)
+                    instr.rhs = valueOf.at(op->getInputs(1).get());
+                if (auto clip = as<ClipObj>(op))
+                    instr.min = clip->getMin(), instr.max = clip->getMax();
+                valueOf[op->getOutput().get()] = leaves.size() + program.size();
+                program.emplace_back(instr);
             }
+
+            auto output = root->getOutput();
+            for (auto &op : members)
+            {
+                removeOperatorAndDisconnect(op);
+                if (op != root)
+                    removeTensor(op->getOutput());
+            }
+            addOpWithOutputs<FusedElementWiseObj>(leaves, output, program);
         }
-        return nullptr;
+        IT_ASSERT(topo_sort() == true);
+    }
+
+    Tensor GraphObj::getTensor(int fuid) const
+    {
+        auto it = tensorByFuid.find(fuid);
+        return it == tensorByFuid.end() ? nullptr : it->second;
     }
 
     void GraphObj::shape_infer()
     {
+        compact();
+        invalidatePlan();
         for (auto &op : ops)
         {
             auto ans = op->inferShape();
@@ -367,73 +1291,204 @@ namespace infini
         }
     }
 
-    void GraphObj::dataMalloc()
+    MemoryPlanner GraphObj::memoryLifetimes(vector<TensorVec> &blocks)
     {
-        // topological sorting first
         IT_ASSERT(topo_sort() == true);
+        // Operator i runs at step i. Graph inputs are live from the start,
+        // graph outputs until after the last step.
+        std::unordered_map<OperatorObj *, size_t> step;
+        for (size_t i = 0; i < ops.size(); ++i)
+            step[ops[i].get()] = i;
+        std::unordered_map<TensorObj *, std::pair<size_t, size_t>> lifetime;
+        for (auto &tensor : tensors)
+        {
+            // constants live in their own persistent memory
+            if (tensor->isConstant())
+                continue;
+            auto source = tensor->getSource();
+            size_t first = source ? step.at(source.get()) : 0;
+            size_t last = tensor->getTargets().empty() ? ops.size() : first;
+            for (auto &target : tensor->getTargets())
+                last = std::max(last, step.at(target.get()));
+            lifetime[tensor.get()] = {first, last};
+        }
 
-        // =================================== 作业 ===================================
-        // TODO：利用 allocator 给计算图分配内存
-        // HINT: 获取分配好的内存指针后，可以调用 tensor 的 setDataBlob 函数给 tensor 绑定内存
-        // =================================== 作业 ===================================
-
-        // count the number of times all tensors are used
-        std::unordered_map<TensorObj *, size_t> tensorToRefCount;
-        // record the memory address offsets of all tensors to be allocated
-        std::unordered_map<TensorObj *, size_t> tensorToOffset;
-
-        for (auto &tensor : tensors) {
-            tensorToRefCount[tensor.get()] = tensor->getTargets().size();
-            // allocate memory for all user-created tensors
-            if (tensor.get()->getSource() == nullptr) {
-                tensorToOffset[tensor.get()] =
-                    allocator.alloc(tensor->getBytes());
-            }
-        }  
-
-        // traverse in topological order and simulate memory allocation
-        for (auto &op : ops) {
-            // memory should be allocated for the op's output first
-            auto outputs = op->getOutputs();
-            for (auto &tensor : outputs) {
-                if (tensor) {
-                    tensorToOffset[tensor.get()] =
-                        allocator.alloc(tensor->getBytes());
+        // An output the kernel can write over an input that its operator
+        // reads last shares the block of that input.
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        std::unordered_map<TensorObj *, Tensor> aliasOf;
+        for (auto &op : ops)
+        {
+            if (op->numOutputs() != 1 || op->getOutput()->isConstant())
+                continue;
+            auto kernel = kernelRegistry.getKernel(
+                {runtime->getDevice(), op->getOpType().underlying()});
+            for (int i : kernel->getInPlaceInputs(op))
+            {
+                auto input = op->getInputs(i);
+                if (!input->isConstant() &&
+                    lifetime.at(input.get()).second == step.at(op.get()))
+                {
+                    aliasOf[op->getOutput().get()] = input;
+                    break;
                 }
             }
-            auto inputs = op->getInputs();
-            for (auto &tensor : inputs) {
-                if (tensor) {
-                    auto tensorIter = tensorToRefCount.find(tensor.get());
-                    IT_ASSERT(tensorIter != tensorToRefCount.end());
-                    IT_ASSERT(tensorToRefCount[tensor.get()] > 0);
-                    tensorToRefCount[tensor.get()] -= 1;
-                    if (tensorToRefCount[tensor.get()] == 0) {
-                        // indicate that this tensor will no longer be used and
-                        // perform memory free
-                        tensorToRefCount.erase(tensor.get());
-                        allocator.free(tensorToOffset[tensor.get()],
-                                        tensor->getBytes());
-                    }
-                }
+        }
+
+        blocks.clear();
+        std::unordered_map<TensorObj *, size_t> blockOf;
+        vector<std::pair<size_t, size_t>> blockLifetime;
+        for (auto &tensor : tensors)
+            if (!tensor->isConstant() && !aliasOf.count(tensor.get()))
+            {
+                blockOf[tensor.get()] = blocks.size();
+                blocks.push_back({tensor});
+                blockLifetime.emplace_back(lifetime.at(tensor.get()));
             }
-        }    
+        // In topological order the input of an alias already has a block.
+        for (auto &op : ops)
+        {
+            if (op->numOutputs() != 1)
+                continue;
+            auto it = aliasOf.find(op->getOutput().get());
+            if (it == aliasOf.end())
+                continue;
+            size_t block = blockOf.at(it->second.get());
+            blockOf[it->first] = block;
+            blocks[block].emplace_back(op->getOutput());
+            blockLifetime[block].second = std::max(
+                blockLifetime[block].second, lifetime.at(it->first).second);
+        }
 
-        // perform actual memory allocation for non-weight tensors
-        for (auto &tensor : tensors) {
-            IT_ASSERT(tensorToOffset.find(tensor.get()) !=
-                    tensorToOffset.end());
-            tensor->setDataBlob(make_ref<BlobObj>(
-                tensor->runtime, static_cast<uint8_t *>(allocator.getPtr()) +
-                                    tensorToOffset[tensor.get()]));
-        }        
+        MemoryPlanner planner;
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            size_t bytes = 0;
+            for (auto &tensor : blocks[i])
+                bytes = std::max(bytes, tensor->getBytes());
+            planner.addBlock(bytes, blockLifetime[i].first,
+                             blockLifetime[i].second);
+        }
+        return planner;
+    }
+
+    vector<MemoryPlanner::Plan> GraphObj::planMemory()
+    {
+        vector<TensorVec> blocks;
+        auto planner = memoryLifetimes(blocks);
+        vector<MemoryPlanner::Plan> ret;
+        for (auto strategy : MemoryPlanner::strategies)
+            ret.emplace_back(planner.plan(strategy));
+        return ret;
+    }
+
+    void GraphObj::dataMalloc(optional<MemoryPlanner::Strategy> strategy)
+    {
+        invalidatePlan();
+        vector<TensorVec> blocks;
+        auto planner = memoryLifetimes(blocks);
+        auto plan = strategy ? planner.plan(*strategy) : planner.planBest();
+
+        // The whole plan is one block of the arena.
+        size_t base = allocator.alloc(plan.peak);
+        auto ptr = static_cast<uint8_t *>(allocator.getPtr()) + base;
+        memoryDependencies.clear();
+        TensorVec planned;
+        std::unordered_map<TensorObj *, size_t> offset;
+        for (size_t i = 0; i < blocks.size(); ++i)
+            for (auto &tensor : blocks[i])
+            {
+                offset[tensor.get()] = plan.offsets[i];
+                tensor->setDataBlob(
+                    make_ref<BlobObj>(runtime, ptr + plan.offsets[i]));
+                planned.emplace_back(tensor);
+            }
+
+        // An output may reuse the memory of tensors that died earlier, or of
+        // the input it is written over. Their other readers are ordered
+        // before its producer only by the sequential schedule, so record the
+        // write-after-read edges a concurrent executor has to respect. Only
+        // the last tensor held in each byte range matters: the readers of
+        // earlier ones are ordered before its producer already.
+        std::unordered_map<TensorObj *, size_t> lastUse;
+        for (size_t i = 0; i < ops.size(); ++i)
+            for (auto &input : ops[i]->getInputs())
+                lastUse[input.get()] = i;
+        // Disjoint byte ranges by begin: the end and the tensor held there.
+        std::map<size_t, std::pair<size_t, Tensor>> occupant;
+        auto hold = [&](const Tensor &tensor, auto &&visit)
+        {
+            size_t begin = offset[tensor.get()];
+            size_t end = begin + tensor->getBytes();
+            if (begin == end)
+                return;
+            auto it = occupant.lower_bound(begin);
+            if (it != occupant.begin() && std::prev(it)->second.first > begin)
+                --it;
+            while (it != occupant.end() && it->first < end)
+            {
+                auto [oldBegin, held] = *it;
+                auto [oldEnd, old] = held;
+                visit(old);
+                it = occupant.erase(it);
+                if (oldBegin < begin)
+                    occupant.emplace(oldBegin, std::make_pair(begin, old));
+                if (oldEnd > end)
+                    occupant.emplace(end, std::make_pair(oldEnd, old));
+            }
+            occupant.emplace(begin, std::make_pair(end, tensor));
+        };
+        for (auto &tensor : planned)
+            if (!tensor->getSource())
+                hold(tensor, [](const Tensor &) {});
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            auto &op = ops[i];
+            OpVec deps;
+            std::unordered_set<OperatorObj *> seen;
+            for (auto &output : op->getOutputs())
+            {
+                if (!offset.count(output.get()))
+                    continue;
+                hold(output, [&](const Tensor &dead)
+                     {
+                         auto last = lastUse.find(dead.get());
+                         if (dead == output || last == lastUse.end() ||
+                             last->second > i)
+                             return;
+                         for (auto &reader : dead->getTargets())
+                             if (reader != op && seen.insert(reader.get()).second)
+                                 deps.emplace_back(reader);
+                     });
+            }
+            if (!deps.empty())
+                memoryDependencies[op.get()] = std::move(deps);
+        }
 
         allocator.info();
     }
 
     Tensor GraphObj::addTensor(Shape dim, DataType dtype)
     {
-        return tensors.emplace_back(make_ref<TensorObj>(dim, dtype, runtime));
+        return addTensor(make_ref<TensorObj>(dim, dtype, runtime));
+    }
+
+    Tensor GraphObj::addConstant(Shape dim, DataType dtype)
+    {
+        auto tensor = addTensor(std::move(dim), dtype);
+        bindConstant(tensor);
+        return tensor;
+    }
+
+    void GraphObj::bindConstant(const Tensor &tensor)
+    {
+        invalidatePlan();
+        auto ptr = runtime->alloc(tensor->getBytes());
+        constantMemory[tensor.get()] = std::shared_ptr<void>(
+            ptr, [runtime = runtime](void *ptr)
+            { runtime->dealloc(ptr); });
+        tensor->setDataBlob(make_ref<BlobObj>(runtime, ptr));
+        tensor->constant = true;
     }
 
     Tensor GraphObj::addTensor(const Tensor &tensor)
@@ -442,10 +1497,62 @@ namespace infini
                   std::string("Tensor runtime mismatch: cannot add a tenosr in ") +
                       tensor->getRuntime()->toString() + " to " +
                       runtime->toString());
+        if (tensorPosition.count(tensor.get()))
+            return tensor;
+        IT_ASSERT(tensorByFuid.emplace(tensor->getFuid(), tensor).second,
+                  "Duplicate tensor fuid " + std::to_string(tensor->getFuid()));
+        tensorPosition[tensor.get()] = tensors.size();
         tensors.emplace_back(tensor);
         return tensor;
     }
 
+    void GraphObj::removeOperator(const Operator &op)
+    {
+        // The slot is cleared in O(1). Removing an operator keeps the
+        // others in order.
+        auto it = position.find(op.get());
+        if (it == position.end())
+            return;
+        invalidatePlan();
+        ops[it->second] = nullptr;
+        position.erase(it);
+        ++removedOps;
+    }
+
+    void GraphObj::removeTensor(const Tensor &tensor)
+    {
+        auto it = tensorPosition.find(tensor.get());
+        if (it == tensorPosition.end())
+            return;
+        invalidatePlan();
+        tensors[it->second] = nullptr;
+        tensorPosition.erase(it);
+        ++removedTensors;
+        tensorByFuid.erase(tensor->getFuid());
+        // The memory of a constant belongs to the graph.
+        if (constantMemory.erase(tensor.get()))
+            tensor->setDataBlob(nullptr);
+    }
+
+    void GraphObj::compact() const
+    {
+        if (removedOps)
+        {
+            ops.erase(std::remove(ops.begin(), ops.end(), nullptr), ops.end());
+            for (size_t i = 0; i < ops.size(); ++i)
+                position[ops[i].get()] = i;
+            removedOps = 0;
+        }
+        if (removedTensors)
+        {
+            tensors.erase(std::remove(tensors.begin(), tensors.end(), nullptr),
+                          tensors.end());
+            for (size_t i = 0; i < tensors.size(); ++i)
+                tensorPosition[tensors[i].get()] = i;
+            removedTensors = 0;
+        }
+    }
+
     TensorVec GraphObj::addTensor(const TensorVec &tensors)
     {
         for (auto &t : tensors)
@@ -459,36 +1566,35 @@ namespace infini
     // "predecessors" and "successors" of an operator of "ops" must be in "ops".
     bool GraphObj::checkValid() const
     {
-        for (auto tensor : tensors)
+        compact();
+        for (const auto &tensor : tensors)
         {
             IT_ASSERT(!(tensor->getTargets().size() == 0 &&
                         nullptr == tensor->getSource()));
-            for (auto op : tensor->getTargets())
+            for (const auto &op : tensor->getTargets())
             {
-                IT_ASSERT(std::find(ops.begin(), ops.end(), op) != ops.end());
+                IT_ASSERT(position.count(op.get()));
             }
             auto op = tensor->getSource();
-            IT_ASSERT(!(op && std::find(ops.begin(), ops.end(), op) == ops.end()));
+            IT_ASSERT(!(op && !position.count(op.get())));
         }
-        for (auto op : ops)
+        for (const auto &op : ops)
         {
-            for (auto tensor : op->getInputs())
+            for (const auto &tensor : op->getInputs())
             {
-                IT_ASSERT(std::find(tensors.begin(), tensors.end(), tensor) !=
-                          tensors.end());
+                IT_ASSERT(tensorPosition.count(tensor.get()));
             }
-            for (auto tensor : op->getOutputs())
+            for (const auto &tensor : op->getOutputs())
             {
-                IT_ASSERT(std::find(tensors.begin(), tensors.end(), tensor) !=
-                          tensors.end());
+                IT_ASSERT(tensorPosition.count(tensor.get()));
             }
-            for (auto pre : op->getPredecessors())
+            for (const auto &pre : op->getPredecessors())
             {
-                IT_ASSERT(std::find(ops.begin(), ops.end(), pre) != ops.end());
+                IT_ASSERT(position.count(pre.get()));
             }
-            for (auto suc : op->getSuccessors())
+            for (const auto &suc : op->getSuccessors())
             {
-                IT_ASSERT(std::find(ops.begin(), ops.end(), suc) != ops.end());
+                IT_ASSERT(position.count(suc.get()));
             }
         }
         std::set<UidBaseType> s;
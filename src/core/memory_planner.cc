@@ -0,0 +1,147 @@
+#include "core/memory_planner.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace infini
+{
+    size_t MemoryPlanner::addBlock(size_t bytes, size_t first, size_t last)
+    {
+        IT_ASSERT(first <= last);
+        size_t size = (bytes + alignment - 1) / alignment * alignment;
+        blocks.push_back({size, first, last});
+        return blocks.size() - 1;
+    }
+
+    size_t MemoryPlanner::findOffset(size_t id, const vector<size_t> &offsets,
+                                     const vector<bool> &placed,
+                                     bool bestFit) const
+    {
+        const auto &block = blocks[id];
+        vector<std::pair<size_t, size_t>> live;
+        for (size_t i = 0; i < blocks.size(); ++i)
+            if (placed[i] && blocks[i].size > 0 &&
+                blocks[i].first <= block.last && block.first <= blocks[i].last)
+                live.emplace_back(offsets[i], offsets[i] + blocks[i].size);
+        std::sort(live.begin(), live.end());
+        size_t end = 0, best = SIZE_MAX, bestGap = SIZE_MAX;
+        for (auto &[begin, blockEnd] : live)
+        {
+            if (begin >= end + block.size)
+            {
+                if (!bestFit)
+                    return end;
+                if (begin - end < bestGap)
+                {
+                    best = end;
+                    bestGap = begin - end;
+                }
+            }
+            end = std::max(end, blockEnd);
+        }
+        return best == SIZE_MAX ? end : best;
+    }
+
+    MemoryPlanner::Plan MemoryPlanner::plan(Strategy strategy) const
+    {
+        const size_t n = blocks.size();
+        vector<size_t> offsets(n, 0);
+        vector<bool> placed(n, false);
+        // Ties go to the block that starts first, so plans are stable.
+        vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        auto bySize = [&](size_t a, size_t b)
+        {
+            return blocks[a].size != blocks[b].size
+                       ? blocks[a].size > blocks[b].size
+                       : blocks[a].first < blocks[b].first;
+        };
+        auto place = [&](size_t id, bool bestFit)
+        {
+            offsets[id] = findOffset(id, offsets, placed, bestFit);
+            placed[id] = true;
+        };
+
+        switch (strategy)
+        {
+        case Strategy::GreedyBySize:
+            std::stable_sort(order.begin(), order.end(), bySize);
+            for (auto id : order)
+                place(id, true);
+            break;
+        case Strategy::GreedyByBreadth:
+        {
+            size_t steps = 0;
+            for (auto &block : blocks)
+                steps = std::max(steps, block.last + 1);
+            vector<size_t> breadth(steps, 0);
+            vector<vector<size_t>> liveAt(steps);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t s = blocks[i].first; s <= blocks[i].last; ++s)
+                {
+                    breadth[s] += blocks[i].size;
+                    liveAt[s].emplace_back(i);
+                }
+            vector<size_t> stepOrder(steps);
+            std::iota(stepOrder.begin(), stepOrder.end(), 0);
+            std::stable_sort(stepOrder.begin(), stepOrder.end(),
+                             [&](size_t a, size_t b)
+                             { return breadth[a] > breadth[b]; });
+            for (auto s : stepOrder)
+            {
+                std::stable_sort(liveAt[s].begin(), liveAt[s].end(), bySize);
+                for (auto id : liveAt[s])
+                    if (!placed[id])
+                        place(id, true);
+            }
+            break;
+        }
+        case Strategy::IntervalColoring:
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t a, size_t b)
+                             {
+                                 return blocks[a].first != blocks[b].first
+                                            ? blocks[a].first < blocks[b].first
+                                            : bySize(a, b);
+                             });
+            for (auto id : order)
+                place(id, false);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+
+        size_t peak = 0;
+        for (size_t i = 0; i < n; ++i)
+            peak = std::max(peak, offsets[i] + blocks[i].size);
+        return {strategy, std::move(offsets), peak};
+    }
+
+    MemoryPlanner::Plan MemoryPlanner::planBest() const
+    {
+        optional<Plan> best;
+        for (auto strategy : strategies)
+        {
+            auto candidate = plan(strategy);
+            if (!best || candidate.peak < best->peak)
+                best = std::move(candidate);
+        }
+        return *best;
+    }
+
+    const char *MemoryPlanner::toString(Strategy strategy)
+    {
+        switch (strategy)
+        {
+        case Strategy::GreedyBySize:
+            return "GreedyBySize";
+        case Strategy::GreedyByBreadth:
+            return "GreedyByBreadth";
+        case Strategy::IntervalColoring:
+            return "IntervalColoring";
+        default:
+            return "Unknown";
+        }
+    }
+
+} // namespace infini
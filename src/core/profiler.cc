@@ -0,0 +1,147 @@
+#include "core/profiler.h"
+#include "core/operator.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+namespace infini
+{
+    namespace
+    {
+        int currentThreadId()
+        {
+            static std::atomic<int> nextId{0};
+            thread_local int id = nextId++;
+            return id;
+        }
+
+        string shapesToString(const TensorVec &tensors)
+        {
+            string ret;
+            for (auto &tensor : tensors)
+            {
+                if (!ret.empty())
+                    ret += ";";
+                ret += tensor ? vecToString(tensor->getDims()) : "null";
+            }
+            return ret;
+        }
+
+        string jsonString(const string &str)
+        {
+            string ret = "\"";
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    ret += '\\';
+                ret += c;
+            }
+            return ret + "\"";
+        }
+    } // namespace
+
+    void Profiler::record(const Operator &op, const string &kernelName,
+                          Clock::time_point begin, Clock::time_point end)
+    {
+        using Micros = std::chrono::duration<double, std::micro>;
+        Record rec{op->getOpType().toString(),
+                   kernelName,
+                   shapesToString(op->getInputs()) + " -> " +
+                       shapesToString(op->getOutputs()),
+                   op->getDType().toString(),
+                   currentThreadId(),
+                   0,
+                   Micros(end - begin).count()};
+        std::lock_guard<std::mutex> lock(mutex);
+        rec.start = Micros(begin - epoch).count();
+        records.emplace_back(std::move(rec));
+    }
+
+    void Profiler::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        records.clear();
+        epoch = Clock::now();
+    }
+
+    vector<Profiler::Record> Profiler::getRecords() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return records;
+    }
+
+    void Profiler::printSummary(std::ostream &os) const
+    {
+        struct Entry
+        {
+            size_t count = 0;
+            double total = 0;
+        };
+        std::map<string, Entry> byType;
+        Entry all;
+        for (auto &rec : getRecords())
+        {
+            auto &entry = byType[rec.opType];
+            entry.count += 1;
+            entry.total += rec.duration;
+            all.count += 1;
+            all.total += rec.duration;
+        }
+        vector<pair<string, Entry>> rows(byType.begin(), byType.end());
+        std::sort(rows.begin(), rows.end(), [](auto &a, auto &b)
+                  { return a.second.total > b.second.total; });
+
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::left << std::setw(16) << "Op" << std::right
+           << std::setw(8) << "Count" << std::setw(14) << "Total(ms)"
+           << std::setw(14) << "Mean(us)" << std::setw(10) << "Share"
+           << "\n";
+        os << std::fixed;
+        for (auto &[type, entry] : rows)
+            os << std::left << std::setw(16) << type << std::right
+               << std::setw(8) << entry.count << std::setw(14)
+               << std::setprecision(3) << entry.total / 1000 << std::setw(14)
+               << entry.total / entry.count << std::setw(9)
+               << std::setprecision(1)
+               << (all.total > 0 ? 100 * entry.total / all.total : 0)
+               << "%\n";
+        os << std::left << std::setw(16) << "Total" << std::right
+           << std::setw(8) << all.count << std::setw(14)
+           << std::setprecision(3) << all.total / 1000 << "\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void Profiler::exportChromeTrace(std::ostream &os) const
+    {
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::fixed << std::setprecision(3);
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        for (auto &rec : getRecords())
+        {
+            os << (first ? "\n" : ",\n");
+            first = false;
+            os << "{\"name\":" << jsonString(rec.kernelName)
+               << ",\"cat\":" << jsonString(rec.opType)
+               << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << rec.threadId
+               << ",\"ts\":" << rec.start << ",\"dur\":" << rec.duration
+               << ",\"args\":{\"op\":" << jsonString(rec.opType)
+               << ",\"shapes\":" << jsonString(rec.shapes)
+               << ",\"dtype\":" << jsonString(rec.dtype) << "}}";
+        }
+        os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void Profiler::exportChromeTrace(const string &path) const
+    {
+        std::ofstream file(path);
+        IT_ASSERT(file.is_open(), "Cannot open " + path);
+        exportChromeTrace(file);
+    }
+
+} // namespace infini
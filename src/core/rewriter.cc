@@ -0,0 +1,228 @@
+#include "core/rewriter.h"
+#include <numeric>
+
+namespace infini
+{
+    Pattern Pattern::any()
+    {
+        Pattern ret;
+        ret.anyTensor = true;
+        return ret;
+    }
+
+    Pattern Pattern::op(OpType type, vector<Pattern> operands)
+    {
+        return op(vector<OpType>{type}, std::move(operands));
+    }
+
+    Pattern Pattern::op(vector<OpType> types, vector<Pattern> operands)
+    {
+        Pattern ret;
+        ret.types = std::move(types);
+        ret.operands = std::move(operands);
+        return ret;
+    }
+
+    Pattern &Pattern::where(Predicate pred)
+    {
+        predicates.emplace_back(std::move(pred));
+        return *this;
+    }
+
+    Pattern &Pattern::singleUse()
+    {
+        oneUse = true;
+        return *this;
+    }
+
+    Pattern &Pattern::commutative()
+    {
+        IT_ASSERT(operands.size() == 2);
+        swappable = true;
+        return *this;
+    }
+
+    bool Pattern::match(const Operator &op, OpVec &matched) const
+    {
+        IT_ASSERT(!anyTensor);
+        if (!types.empty() &&
+            std::find(types.begin(), types.end(), op->getOpType()) ==
+                types.end())
+            return false;
+        for (auto &pred : predicates)
+            if (!pred(op))
+                return false;
+        if (operands.size() > op->getInputs().size())
+            return false;
+        const size_t size = matched.size();
+        matched.emplace_back(op);
+        vector<int> order(operands.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (matchOperands(op, order, matched))
+            return true;
+        matched.resize(size + 1);
+        if (swappable && matchOperands(op, {1, 0}, matched))
+            return true;
+        matched.resize(size);
+        return false;
+    }
+
+    bool Pattern::matchOperands(const Operator &op, const vector<int> &order,
+                                OpVec &matched) const
+    {
+        for (size_t i = 0; i < operands.size(); ++i)
+            if (!matchOperand(operands[order[i]], op->getInputs(i), op,
+                              matched))
+                return false;
+        return true;
+    }
+
+    bool Pattern::matchOperand(const Pattern &pattern, const Tensor &tensor,
+                               const Operator &parent, OpVec &matched) const
+    {
+        if (pattern.anyTensor)
+            return true;
+        auto source = tensor->getSource();
+        if (!source)
+            return false;
+        if (pattern.oneUse)
+        {
+            auto targets = tensor->getTargets();
+            if (!std::all_of(targets.begin(), targets.end(),
+                             [&](auto &target)
+                             { return target == parent; }))
+                return false;
+        }
+        return pattern.match(source, matched);
+    }
+
+    bool GraphRewriter::apply(const vector<RewriteRule> &rules)
+    {
+        IT_ASSERT(graph.topo_sort() == true);
+        for (auto &op : graph.getOperators())
+            push(op);
+        // Every rule is expected to shrink the graph or its cost, so a long
+        // run means two rules undo each other.
+        const size_t limit = 64 * (graph.getOperators().size() + 1);
+        size_t applied = 0;
+        while (!worklist.empty())
+        {
+            auto op = worklist.front();
+            worklist.pop_front();
+            queued.erase(op);
+            if (erased.count(op))
+                continue;
+            for (auto &rule : rules)
+            {
+                OpVec matched;
+                if (!rule.pattern.match(op, matched) ||
+                    !rule.rewrite(matched, *this))
+                    continue;
+                IT_ASSERT(++applied <= limit,
+                          "Rewrite rules do not converge, last: " + rule.name);
+                break;
+            }
+        }
+        IT_ASSERT(graph.topo_sort() == true);
+        return applied > 0;
+    }
+
+    Tensor GraphRewriter::addTensor(Shape dim, DataType dtype)
+    {
+        return graph.addTensor(std::move(dim), dtype);
+    }
+
+    void GraphRewriter::replaceInput(const Operator &op, size_t index,
+                                     const Tensor &tensor)
+    {
+        auto old = op->getInputs(index);
+        graph.replaceInput(op, index, tensor);
+        push(op);
+        touch(old);
+        touch(tensor);
+        removeIfDangling(old);
+    }
+
+    void GraphRewriter::addInput(const Operator &op, const Tensor &tensor)
+    {
+        graph.addInput(op, tensor);
+        push(op);
+        touch(tensor);
+    }
+
+    void GraphRewriter::replaceOutput(const Operator &op, size_t index,
+                                      const Tensor &tensor)
+    {
+        auto old = op->getOutputs()[index];
+        touch(old);
+        graph.replaceOutput(op, index, tensor);
+        push(op);
+        touch(tensor);
+        removeIfDangling(old);
+    }
+
+    void GraphRewriter::replaceAllUses(const Tensor &from, const Tensor &to)
+    {
+        for (auto &target : from->getTargets())
+        {
+            const auto &inputs = target->getInputs();
+            for (size_t i = 0; i < inputs.size(); ++i)
+                if (inputs[i] == from)
+                    replaceInput(target, i, to);
+        }
+    }
+
+    void GraphRewriter::eraseOp(const Operator &op)
+    {
+        for (auto &output : op->getOutputs())
+            touch(output);
+        graph.removeOperatorAndDisconnect(op);
+        erased.insert(op);
+        for (auto &input : op->getInputs())
+        {
+            touch(input);
+            removeIfDangling(input);
+        }
+    }
+
+    bool GraphRewriter::eraseIfUnread(const Operator &op)
+    {
+        for (auto &output : op->getOutputs())
+            if (!output->getTargets().empty())
+                return false;
+        eraseOp(op);
+        for (auto &output : op->getOutputs())
+            graph.removeTensor(output);
+        return true;
+    }
+
+    void GraphRewriter::push(const Operator &op)
+    {
+        if (queued.insert(op).second)
+            worklist.emplace_back(op);
+    }
+
+    void GraphRewriter::touch(const Tensor &tensor)
+    {
+        if (auto source = tensor->getSource())
+            push(source);
+        for (auto &target : tensor->getTargets())
+            push(target);
+    }
+
+    void GraphRewriter::created(const Operator &op)
+    {
+        push(op);
+        for (auto &input : op->getInputs())
+            touch(input);
+        for (auto &output : op->getOutputs())
+            touch(output);
+    }
+
+    void GraphRewriter::removeIfDangling(const Tensor &tensor)
+    {
+        if (!tensor->getSource() && tensor->getTargets().empty())
+            graph.removeTensor(tensor);
+    }
+
+} // namespace infini
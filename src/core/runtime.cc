@@ -1,23 +1,59 @@
 #include "core/runtime.h"
 #include "core/blob.h"
-#include "core/kernel.h"
+#include "core/execution_plan.h"
 #include "core/graph.h"
 #include "core/kernel.h"
+#include "core/profiler.h"
 #include <chrono>
 #include <cstring>
 #include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 namespace infini
 {
+    ExecutionPlan RuntimeObj::compile(const Graph &graph) const
+    {
+        return make_ref<ExecutionPlanObj>(graph, this);
+    }
+
+    void RuntimeObj::setProfiling(bool enable)
+    {
+        profiler = enable ? make_ref<Profiler>() : nullptr;
+    }
+
     void NativeCpuRuntimeObj::run(const Graph &graph) const
     {
-        const auto &kernelRegistry = KernelRegistry::getInstance();
+        // Repeated runs of an unchanged graph reuse its prepared kernels.
+        auto plan = graph->getCachedPlan(this);
+        if (!plan)
+        {
+            plan = compile(graph);
+            graph->cachePlan(plan, this);
+        }
+        if (pool)
+            plan->run(*pool);
+        else
+            plan->run();
+    }
 
-        for (auto &op : graph->getOperators())
+    void NativeCpuRuntimeObj::setParallelism(size_t interOpThreads,
+                                             int intraOpThreads)
+    {
+        IT_ASSERT(interOpThreads > 0 && intraOpThreads >= 0);
+        pool.reset();
+        if (interOpThreads == 1)
+            return;
+        if (intraOpThreads == 0)
         {
-            auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-            Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
-            kernel->compute(op, this);
+#ifdef _OPENMP
+            intraOpThreads = std::max(1, omp_get_max_threads() /
+                                             (int)interOpThreads);
+#else
+            intraOpThreads = 1;
+#endif
         }
+        pool = std::make_unique<ThreadPool>(interOpThreads, intraOpThreads);
     }
 
     string NativeCpuRuntimeObj::toString() const { return "CPU Runtime"; }
@@ -0,0 +1,259 @@
+#include "operators/unary.h"
+#include "core/kernel.h"
+#include <limits>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace infini
+{
+    class NativeCast : public CpuKernelWithoutConfig
+    {
+        static constexpr size_t parallelThreshold = 1 << 15;
+        static constexpr size_t chunkSize = 1 << 14;
+
+        static uint32_t floatBits(float val)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &val, sizeof(bits));
+            return bits;
+        }
+
+        static float bitsFloat(uint32_t bits)
+        {
+            float val;
+            std::memcpy(&val, &bits, sizeof(val));
+            return val;
+        }
+
+        // Round-to-nearest-even float -> IEEE half. Bit-exact with F16C,
+        // including subnormals, overflow to infinity and quiet NaNs.
+        static uint16_t floatToHalf(float val)
+        {
+            const uint32_t infBits = 255u << 23;
+            const uint32_t halfOverflow = (127u + 16) << 23;
+            const uint32_t denormMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+            uint32_t u = floatBits(val);
+            const uint32_t sign = u & 0x80000000u;
+            u ^= sign;
+            uint16_t ret;
+            if (u >= halfOverflow)
+                ret = u > infBits ? 0x7e00 : 0x7c00;
+            else if (u < (113u << 23))
+                // The result is a half subnormal or zero: let the FPU round
+                // the mantissa by adding a magic number.
+                ret = floatBits(bitsFloat(u) + bitsFloat(denormMagic)) -
+                      denormMagic;
+            else
+            {
+                const uint32_t mantissaOdd = (u >> 13) & 1;
+                u += ((15u - 127) << 23) + 0xfff + mantissaOdd;
+                ret = u >> 13;
+            }
+            return ret | (sign >> 16);
+        }
+
+        static float halfToFloat(uint16_t val)
+        {
+            const uint32_t shiftedExp = 0x7c00u << 13;
+            uint32_t u = (val & 0x7fffu) << 13;
+            const uint32_t exp = shiftedExp & u;
+            u += (127u - 15) << 23;
+            if (exp == shiftedExp) // Inf or NaN
+                u += (128u - 16) << 23;
+            else if (exp == 0) // zero or subnormal: renormalize
+                u = floatBits(bitsFloat(u + (1u << 23)) - bitsFloat(113u << 23));
+            return bitsFloat(u | ((val & 0x8000u) << 16));
+        }
+
+        // Round-to-nearest-even float -> bfloat16 with integer ops only.
+        static uint16_t floatToBFloat16(float val)
+        {
+            uint32_t u = floatBits(val);
+            if ((u & 0x7fffffffu) > 0x7f800000u) // keep NaN quiet
+                return (u >> 16) | 0x40;
+            return (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+        }
+
+        static float bfloat16ToFloat(uint16_t val) { return bitsFloat(uint32_t(val) << 16); }
+
+        // Numeric conversion. Narrowing to an integer type saturates to the
+        // range of the destination; NaN becomes 0.
+        template <typename Src, typename Dst>
+        static Dst convert(Src val)
+        {
+            if constexpr (std::is_floating_point_v<Src> && std::is_integral_v<Dst>)
+            {
+                constexpr Src lo = (Src)std::numeric_limits<Dst>::lowest();
+                constexpr Src hi = (Src)std::numeric_limits<Dst>::max();
+                return val != val   ? Dst(0)
+                       : val <= lo ? std::numeric_limits<Dst>::lowest()
+                       : val >= hi ? std::numeric_limits<Dst>::max()
+                                   : (Dst)val;
+            }
+            else if constexpr (std::is_integral_v<Src> && std::is_integral_v<Dst> &&
+                               sizeof(Dst) < sizeof(Src))
+            {
+                constexpr Src lo = (Src)std::numeric_limits<Dst>::lowest();
+                constexpr Src hi = (Src)std::numeric_limits<Dst>::max();
+                return val < lo ? std::numeric_limits<Dst>::lowest()
+                       : val > hi ? std::numeric_limits<Dst>::max()
+                                  : (Dst)val;
+            }
+            else
+                return (Dst)val;
+        }
+
+        template <typename Src, typename Dst>
+        struct NumericCast
+        {
+            static void run(const Src *src, Dst *dst, size_t n)
+            {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] = convert<Src, Dst>(src[i]);
+            }
+        };
+
+        struct FloatToHalf
+        {
+            static void run(const float *src, uint16_t *dst, size_t n)
+            {
+                size_t i = 0;
+#if defined(__F16C__)
+                for (; i + 8 <= n; i += 8)
+                    _mm_storeu_si128(
+                        reinterpret_cast<__m128i *>(dst + i),
+                        _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                        _MM_FROUND_TO_NEAREST_INT));
+#endif
+                for (; i < n; ++i)
+                    dst[i] = floatToHalf(src[i]);
+            }
+        };
+
+        struct HalfToFloat
+        {
+            static void run(const uint16_t *src, float *dst, size_t n)
+            {
+                size_t i = 0;
+#if defined(__F16C__)
+                for (; i + 8 <= n; i += 8)
+                    _mm256_storeu_ps(dst + i,
+                                     _mm256_cvtph_ps(_mm_loadu_si128(
+                                         reinterpret_cast<const __m128i *>(src + i))));
+#endif
+                for (; i < n; ++i)
+                    dst[i] = halfToFloat(src[i]);
+            }
+        };
+
+        struct FloatToBFloat16
+        {
+            static void run(const float *src, uint16_t *dst, size_t n)
+            {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] = floatToBFloat16(src[i]);
+            }
+        };
+
+        struct BFloat16ToFloat
+        {
+            static void run(const uint16_t *src, float *dst, size_t n)
+            {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] = bfloat16ToFloat(src[i]);
+            }
+        };
+
+        // Split the tensor into contiguous chunks; each chunk runs the
+        // vectorized conversion.
+        template <typename Src, typename Dst, typename Conv>
+        static void castChunks(const Src *inptr, Dst *outptr, size_t n)
+        {
+            const long nChunks = (n + chunkSize - 1) / chunkSize;
+#pragma omp parallel for if (n > parallelThreshold)
+            for (long i = 0; i < nChunks; ++i)
+            {
+                size_t begin = i * chunkSize;
+                Conv::run(inptr + begin, outptr + begin,
+                          std::min(chunkSize, n - begin));
+            }
+        }
+
+        template <typename Src, typename Dst, typename Conv>
+        static Routine doPrepare(const Operator &op)
+        {
+            auto input = op->getInputs(0), output = op->getOutput();
+            IT_ASSERT(input->getDType().getSize() == sizeof(Src));
+            IT_ASSERT(output->getDType().getSize() == sizeof(Dst));
+            const Src *inptr = input->getRawDataPtr<Src *>();
+            Dst *outptr = output->getRawDataPtr<Dst *>();
+            const size_t n = output->size();
+            return [=]
+            { castChunks<Src, Dst, Conv>(inptr, outptr, n); };
+        }
+
+        Routine prepare(const Operator &_op,
+                        const RuntimeObj *context) const override
+        {
+#define CASE_NUMERIC(TYPE, SRC, DST) \
+    case CastType::TYPE:             \
+        return doPrepare<SRC, DST, NumericCast<SRC, DST>>(_op)
+#define CASE_CONVERT(TYPE, SRC, DST, CONV) \
+    case CastType::TYPE:                   \
+        return doPrepare<SRC, DST, CONV>(_op)
+
+            auto op = as<CastObj>(_op);
+            switch (op->getType())
+            {
+                CASE_CONVERT(Float2Float16, float, uint16_t, FloatToHalf);
+                CASE_NUMERIC(Float2Int64, float, int64_t);
+                CASE_NUMERIC(Float2Int32, float, int32_t);
+                CASE_NUMERIC(Float2Int16, float, int16_t);
+                CASE_NUMERIC(Float2Int8, float, int8_t);
+                CASE_CONVERT(Float2BFloat16, float, uint16_t, FloatToBFloat16);
+                CASE_NUMERIC(Int322Float, int32_t, float);
+                CASE_NUMERIC(Int322Int8, int32_t, int8_t);
+                CASE_NUMERIC(Int322Int16, int32_t, int16_t);
+                CASE_NUMERIC(Int322Int64, int32_t, int64_t);
+                CASE_NUMERIC(Int162Float, int16_t, float);
+                CASE_NUMERIC(Int162Int32, int16_t, int32_t);
+                CASE_NUMERIC(Int82Float, int8_t, float);
+                CASE_NUMERIC(Int82Int16, int8_t, int16_t);
+                CASE_NUMERIC(Int82Int32, int8_t, int32_t);
+                CASE_NUMERIC(Uint82Float, uint8_t, float);
+                CASE_NUMERIC(Uint82Int32, uint8_t, int32_t);
+                CASE_NUMERIC(Uint82Int64, uint8_t, int64_t);
+                CASE_NUMERIC(Int642Int32, int64_t, int32_t);
+                CASE_NUMERIC(Int642Uint32, int64_t, uint32_t);
+                CASE_NUMERIC(Int642Float, int64_t, float);
+                CASE_NUMERIC(Uint322Int64, uint32_t, int64_t);
+                CASE_CONVERT(Float162Float, uint16_t, float, HalfToFloat);
+                CASE_CONVERT(BFloat162Float, uint16_t, float, BFloat16ToFloat);
+                CASE_NUMERIC(Float2Float, float, float);
+            default:
+                IT_TODO_HALT();
+            }
+
+#undef CASE_NUMERIC
+#undef CASE_CONVERT
+        }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            prepare(_op, context)();
+        }
+
+        vector<int> getInPlaceInputs(const Operator &op) const override
+        {
+            return sameLayoutInputs(op);
+        }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::Cast, NativeCast, "Cast_CPU");
+
+}; // namespace infini
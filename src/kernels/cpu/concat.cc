@@ -1,64 +1,99 @@
 #include "operators/concat.h"
 #include "core/kernel.h"
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace infini {
 
-class NaiveConcat : public CpuKernelWithoutConfig {
-    template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+class BlockCopyConcat : public CpuKernelWithoutConfig {
+    // Blocks at least this large bypass the cache with non-temporal stores:
+    // they would only evict data the next operators need.
+    static constexpr size_t streamThreshold = 1 << 20;
+    static constexpr size_t parallelThreshold = 1 << 17;
+
+    static void copyBlock(uint8_t *dst, const uint8_t *src, size_t bytes) {
+#if defined(__SSE2__)
+        if (bytes >= streamThreshold) {
+            size_t head = (16 - reinterpret_cast<uintptr_t>(dst) % 16) % 16;
+            std::memcpy(dst, src, head);
+            size_t i = head;
+            for (; i + 16 <= bytes; i += 16)
+                _mm_stream_si128(
+                    reinterpret_cast<__m128i *>(dst + i),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+            std::memcpy(dst + i, src + i, bytes - i);
+            _mm_sfence();
+            return;
+        }
+#endif
+        std::memcpy(dst, src, bytes);
+    }
+
+    // Byte layout of one concat, resolved once.
+    struct ConcatArgs {
+        uint8_t *out;
+        size_t outer, rowBytes, totalBytes;
+        // Bytes each input copies per outer index, where they land in the
+        // output row, and where they come from.
+        vector<size_t> blockBytes, dstOffset;
+        vector<const uint8_t *> srcPtrs;
+    };
+
+    static void concatBlocks(const ConcatArgs &args) {
+        const size_t nInputs = args.srcPtrs.size();
+        const long nTasks = args.outer * nInputs;
+#pragma omp parallel for if (args.totalBytes > parallelThreshold)
+        for (long task = 0; task < nTasks; ++task) {
+            size_t o = task / nInputs, i = task % nInputs;
+            if (args.blockBytes[i] == 0)
+                continue;
+            copyBlock(args.out + o * args.rowBytes + args.dstOffset[i],
+                      args.srcPtrs[i] + o * args.blockBytes[i],
+                      args.blockBytes[i]);
+        }
+    }
+
+    Routine prepare(const Operator &_op,
+                    const RuntimeObj *context) const override {
+        // Every input contributes one contiguous block per outer index, so the
+        // kernel copies raw bytes and works for any data type.
         auto op = as<ConcatObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
+        auto inputs = op->getInputs();
+        auto output = op->getOutput();
         auto dim = op->getDim();
-        auto output = outputs[0];
-        std::vector<Shape> iDims;
-        for (auto input : inputs)
-            iDims.emplace_back(input->getDims());
         const auto &outDim = output->getDims();
-        size_t blockOffsetInner = 1;
-        for (size_t i = outDim.size() - 1; i > (size_t)dim; --i)
-            blockOffsetInner *= outDim[i];
-        size_t blockOffset = outDim[dim] * blockOffsetInner;
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            auto input = inputs[i];
-            auto dimOffset = 0;
-            auto iDim = iDims[i];
-            for (size_t j = 0; j < i; ++j)
-                dimOffset += iDims[j][dim];
-            size_t localBlockOffset = 1;
-            for (size_t i = iDim.size() - 1;
-                 i >= (size_t)dim && i != (size_t)-1; --i)
-                localBlockOffset *= iDim[i];
-            auto innerOffset = blockOffsetInner * dimOffset;
-            auto inSize = input->size();
-            auto inPtr = input->getRawDataPtr<T *>(),
-                 outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
-            }
+        const size_t elemSize = output->getDType().getSize();
+
+        ConcatArgs args;
+        args.out = output->getRawDataPtr<uint8_t *>();
+        args.outer = 1;
+        for (int i = 0; i < dim; ++i)
+            args.outer *= outDim[i];
+        if (args.outer == 0)
+            return [] {};
+        args.totalBytes = output->getBytes();
+        args.rowBytes = args.totalBytes / args.outer;
+
+        size_t offset = 0;
+        for (auto &input : inputs) {
+            IT_ASSERT(input->getDType().getSize() == elemSize);
+            args.blockBytes.emplace_back(input->getBytes() / args.outer);
+            args.dstOffset.emplace_back(offset);
+            args.srcPtrs.emplace_back(input->getRawDataPtr<uint8_t *>());
+            offset += args.blockBytes.back();
         }
+        IT_ASSERT(offset == args.rowBytes);
+        return [args] { concatBlocks(args); };
     }
 
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
-
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
-        default:
-            IT_TODO_HALT();
-        }
+        prepare(_op, context)();
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Concat, NaiveConcat, "ConcatNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Concat, BlockCopyConcat,
+                "ConcatBlockCopy_CPU");
 
 } // namespace infini
@@ -6,110 +6,208 @@ namespace infini
 {
     class NativeElementWise : public CpuKernelWithoutConfig
     {
+        // Below this many output elements the OpenMP fork/join costs more than
+        // the loop itself.
+        static constexpr size_t parallelThreshold = 1 << 15;
+
         template <typename T>
-        static T addCompute(T val0, T val1)
+        struct AddCompute
         {
-            return val0 + val1;
-        }
+            static T apply(T val0, T val1) { return val0 + val1; }
+        };
 
         template <typename T>
-        static T subCompute(T val0, T val1)
+        struct SubCompute
         {
-            return val0 - val1;
-        }
+            static T apply(T val0, T val1) { return val0 - val1; }
+        };
 
         template <typename T>
-        static T mulCompute(T val0, T val1)
+        struct MulCompute
         {
-            return val0 * val1;
-        }
+            static T apply(T val0, T val1) { return val0 * val1; }
+        };
 
         template <typename T>
-        static T divCompute(T val0, T val1)
+        struct DivCompute
+        {
+            static T apply(T val0, T val1) { return (T)(val0 / val1); }
+        };
+
+        // Contiguous inner loop. A stride of 0 means the operand is broadcast
+        // along the row and is hoisted out of the loop, so every variant is a
+        // plain unit-stride loop the compiler can vectorize.
+        template <typename T, typename Op>
+        static void computeRow(const T *a, const T *b, T *c, size_t n,
+                               bool fullA, bool fullB)
         {
-            return (T)(val0 / val1);
+            if (fullA && fullB)
+            {
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    c[i] = Op::apply(a[i], b[i]);
+            }
+            else if (fullB)
+            {
+                const T val0 = *a;
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    c[i] = Op::apply(val0, b[i]);
+            }
+            else if (fullA)
+            {
+                const T val1 = *b;
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    c[i] = Op::apply(a[i], val1);
+            }
+            else
+            {
+                const T val = Op::apply(*a, *b);
+#pragma omp simd
+                for (size_t i = 0; i < n; ++i)
+                    c[i] = val;
+            }
         }
 
+        // Broadcast layout of one element-wise op, resolved once. After
+        // collapse_broadcast the innermost dimension is the contiguous row.
         template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        struct BroadcastArgs
         {
-            auto op = as<ElementWiseObj>(_op);
-            T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
-            T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
-            T *outptr = op->getOutput()->getRawDataPtr<T *>();
-
-            auto shapeA = op->getInputs(0)->getDims();
-            auto shapeB = op->getInputs(1)->getDims();
-            auto shapeC = op->getOutput()->getDims();
-            auto rank = op->getOutput()->getRank();
-            Shape a(rank, 1);
-            Shape b(rank, 1);
-            std::copy(shapeA.begin(), shapeA.end(),
-                      a.begin() + (rank - shapeA.size()));
-            std::copy(shapeB.begin(), shapeB.end(),
-                      b.begin() + (rank - shapeB.size()));
-            auto getStride = [&](const Shape &shape)
+            const T *a, *b;
+            T *c;
+            size_t n, inner;
+            bool fullA, fullB;
+            // Outer output dimensions with the matching broadcast strides of
+            // A and B (0 where the input is broadcast).
+            vector<size_t> outerShape, strideA, strideB;
+        };
+
+        template <typename T, typename Op>
+        static void broadcastCompute(const BroadcastArgs<T> &args)
+        {
+            const size_t n = args.n, inner = args.inner;
+            const bool fullA = args.fullA, fullB = args.fullB;
+            if (n == 0)
+                return;
+            const size_t rows = n / inner;
+
+            if (rows == 1)
+            {
+                // Same shape or a scalar operand: one flat loop, split into
+                // contiguous chunks across threads.
+                const long chunk = 1 << 14;
+                const long nChunks = (n + chunk - 1) / chunk;
+#pragma omp parallel for if (n > parallelThreshold)
+                for (long i = 0; i < nChunks; ++i)
+                {
+                    size_t begin = i * chunk;
+                    size_t len = std::min((size_t)chunk, n - begin);
+                    computeRow<T, Op>(args.a + (fullA ? begin : 0),
+                                      args.b + (fullB ? begin : 0),
+                                      args.c + begin, len, fullA, fullB);
+                }
+                return;
+            }
+
+            // Row/column or general broadcast: iterate over the outer
+            // dimensions with the broadcast strides and run the contiguous
+            // inner loop per row.
+            const size_t outerRank = args.outerShape.size();
+#pragma omp parallel for if (n > parallelThreshold)
+            for (long row = 0; row < (long)rows; ++row)
             {
-                int p = 1;
-                Shape stride(rank);
-                for (auto i = rank; i > 0; --i)
+                size_t rest = row, offsetA = 0, offsetB = 0;
+                for (size_t i = outerRank; i > 0; --i)
                 {
-                    stride[i - 1] = p;
-                    p = p * shape[i - 1];
+                    size_t idx = rest % args.outerShape[i - 1];
+                    rest /= args.outerShape[i - 1];
+                    offsetA += idx * args.strideA[i - 1];
+                    offsetB += idx * args.strideB[i - 1];
                 }
-                return stride;
-            };
-            Shape strideA = getStride(a);
-            Shape strideB = getStride(b);
-
-            auto n = op->getOutput()->size();
-            T (*_doCompute)
-            (T val0, T val1);
+                computeRow<T, Op>(args.a + offsetA, args.b + offsetB,
+                                  args.c + row * inner, inner, fullA, fullB);
+            }
+        }
+
+        template <typename T>
+        static Routine doPrepare(const Operator &_op)
+        {
+            auto op = as<ElementWiseObj>(_op);
+            BroadcastArgs<T> args;
+            args.a = op->getInputs(0)->getRawDataPtr<T *>();
+            args.b = op->getInputs(1)->getRawDataPtr<T *>();
+            args.c = op->getOutput()->getRawDataPtr<T *>();
+
+            Shape shapeC = op->getOutput()->getDims();
+            vector<Shape> shapes{op->getInputs(0)->getDims(),
+                                 op->getInputs(1)->getDims()};
+            collapse_broadcast(shapeC, shapes);
+            const Shape &shapeA = shapes[0], &shapeB = shapes[1];
+            const size_t rank = shapeC.size();
+            args.n = op->getOutput()->size();
+            args.inner = shapeC.back();
+            args.fullA = shapeA.back() != 1;
+            args.fullB = shapeB.back() != 1;
+            args.outerShape.assign(shapeC.begin(), shapeC.end() - 1);
+            args.strideA.resize(rank - 1);
+            args.strideB.resize(rank - 1);
+            size_t sA = shapeA.back(), sB = shapeB.back();
+            for (size_t i = rank - 1; i > 0; --i)
+            {
+                args.strideA[i - 1] = shapeA[i - 1] == 1 ? 0 : sA;
+                args.strideB[i - 1] = shapeB[i - 1] == 1 ? 0 : sB;
+                sA *= shapeA[i - 1];
+                sB *= shapeB[i - 1];
+            }
+
             switch (op->getOpType().underlying())
             {
             case OpType::Add:
-                _doCompute = addCompute<T>;
-                break;
+                return [args]
+                { broadcastCompute<T, AddCompute<T>>(args); };
             case OpType::Sub:
-                _doCompute = subCompute<T>;
-                break;
+                return [args]
+                { broadcastCompute<T, SubCompute<T>>(args); };
             case OpType::Mul:
-                _doCompute = mulCompute<T>;
-                break;
+                return [args]
+                { broadcastCompute<T, MulCompute<T>>(args); };
             case OpType::Div:
-                _doCompute = divCompute<T>;
-                break;
+                return [args]
+                { broadcastCompute<T, DivCompute<T>>(args); };
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t i = 0; i < n; ++i)
-            {
-                auto shapeIndexC = locate_index(i, shapeC);
-                auto indexA = delocate_index(shapeIndexC, a, strideA);
-                auto indexB = delocate_index(shapeIndexC, b, strideB);
-                outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
-            }
         }
 
-        void compute(const Operator &_op,
-                     const RuntimeObj *context) const override
+        Routine prepare(const Operator &_op,
+                        const RuntimeObj *context) const override
         {
 #define CASE(N) \
     case N:     \
-        doCompute<DT<N>::t>(_op, context)
+        return doPrepare<DT<N>::t>(_op)
 
             int dataTypeIdx = _op->getDType().getIndex();
             switch (dataTypeIdx)
             {
                 CASE(1); // DataType::Float32
-                break;
                 CASE(12); // DataType::UInt32
-                break;
             default:
                 IT_TODO_HALT();
             }
         }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            prepare(_op, context)();
+        }
+
+        vector<int> getInPlaceInputs(const Operator &op) const override
+        {
+            return sameLayoutInputs(op);
+        }
     };
 
     REGISTER_KERNEL(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU");
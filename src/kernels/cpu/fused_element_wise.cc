@@ -0,0 +1,224 @@
+#include "operators/fused_element_wise.h"
+#include "core/kernel.h"
+#include "utils/operator_utils.h"
+#include <limits>
+
+namespace infini
+{
+    class FusedElementWise : public CpuKernelWithoutConfig
+    {
+        static constexpr size_t parallelThreshold = 1 << 15;
+        // The whole program runs over one block of a row before moving on, so
+        // the intermediate values of a block stay in L1.
+        static constexpr size_t blockSize = 256;
+
+        template <typename T>
+        struct Instruction
+        {
+            OpType::underlying_t type;
+            int lhs, rhs;
+            // Clip bounds; a missing bound is the limit of T.
+            T lo, hi;
+        };
+
+        // Broadcast layout and program of one fused op, resolved once. After
+        // collapse_broadcast the innermost dimension is the contiguous row.
+        template <typename T>
+        struct FusedArgs
+        {
+            vector<const T *> inputs;
+            T *out;
+            vector<Instruction<T>> program;
+            size_t n, inner;
+            // Per input: whether it varies along the row, and its strides
+            // over the outer output dimensions (0 where broadcast).
+            vector<bool> full;
+            vector<size_t> outerShape;
+            vector<vector<size_t>> strides;
+        };
+
+        template <typename T>
+        static void apply(const Instruction<T> &instr, const T *a, const T *b,
+                          T *dst, size_t len)
+        {
+            switch (instr.type)
+            {
+            case OpType::Add:
+#pragma omp simd
+                for (size_t j = 0; j < len; ++j)
+                    dst[j] = a[j] + b[j];
+                break;
+            case OpType::Sub:
+#pragma omp simd
+                for (size_t j = 0; j < len; ++j)
+                    dst[j] = a[j] - b[j];
+                break;
+            case OpType::Mul:
+#pragma omp simd
+                for (size_t j = 0; j < len; ++j)
+                    dst[j] = a[j] * b[j];
+                break;
+            case OpType::Div:
+#pragma omp simd
+                for (size_t j = 0; j < len; ++j)
+                    dst[j] = (T)(a[j] / b[j]);
+                break;
+            case OpType::Relu:
+#pragma omp simd
+                for (size_t j = 0; j < len; ++j)
+                    dst[j] = a[j] > T(0) ? a[j] : T(0);
+                break;
+            case OpType::Clip:
+            {
+                const T lo = instr.lo, hi = instr.hi;
+#pragma omp simd
+                for (size_t j = 0; j < len; ++j)
+                {
+                    T val = a[j] < lo ? lo : a[j];
+                    dst[j] = val > hi ? hi : val;
+                }
+                break;
+            }
+            default:
+                IT_TODO_HALT();
+            }
+        }
+
+        template <typename T>
+        static void fusedCompute(const FusedArgs<T> &args)
+        {
+            const size_t n = args.n, inner = args.inner;
+            if (n == 0)
+                return;
+            const size_t nInputs = args.inputs.size();
+            const size_t nValues = nInputs + args.program.size();
+            const size_t outerRank = args.outerShape.size();
+            const long blocksPerRow = (inner + blockSize - 1) / blockSize;
+            const long nTasks = n / inner * blocksPerRow;
+
+#pragma omp parallel if (n > parallelThreshold)
+            {
+                // One block per value: broadcast inputs are expanded into
+                // their slot, intermediate results are written to theirs.
+                vector<T> scratch(nValues * blockSize);
+                vector<const T *> values(nValues);
+                vector<size_t> offsets(nInputs);
+#pragma omp for
+                for (long task = 0; task < nTasks; ++task)
+                {
+                    const size_t row = task / blocksPerRow;
+                    const size_t begin = task % blocksPerRow * blockSize;
+                    const size_t len = std::min(blockSize, inner - begin);
+
+                    std::fill(offsets.begin(), offsets.end(), 0);
+                    size_t rest = row;
+                    for (size_t i = outerRank; i > 0; --i)
+                    {
+                        size_t idx = rest % args.outerShape[i - 1];
+                        rest /= args.outerShape[i - 1];
+                        for (size_t k = 0; k < nInputs; ++k)
+                            offsets[k] += idx * args.strides[k][i - 1];
+                    }
+                    for (size_t k = 0; k < nInputs; ++k)
+                    {
+                        const T *src = args.inputs[k] + offsets[k];
+                        if (args.full[k])
+                        {
+                            values[k] = src + begin;
+                            continue;
+                        }
+                        T *slot = scratch.data() + k * blockSize;
+                        std::fill(slot, slot + len, *src);
+                        values[k] = slot;
+                    }
+
+                    for (size_t i = 0; i < args.program.size(); ++i)
+                    {
+                        auto &instr = args.program[i];
+                        T *dst = i + 1 == args.program.size()
+                                     ? args.out + row * inner + begin
+                                     : scratch.data() + (nInputs + i) * blockSize;
+                        apply(instr, values[instr.lhs],
+                              instr.rhs < 0 ? nullptr : values[instr.rhs], dst,
+                              len);
+                        values[nInputs + i] = dst;
+                    }
+                }
+            }
+        }
+
+        template <typename T>
+        static Routine doPrepare(const Operator &_op)
+        {
+            auto op = as<FusedElementWiseObj>(_op);
+            FusedArgs<T> args;
+            for (auto &input : op->getInputs())
+                args.inputs.emplace_back(input->getRawDataPtr<T *>());
+            args.out = op->getOutput()->getRawDataPtr<T *>();
+            for (auto &instr : op->getProgram())
+                args.program.push_back(
+                    {instr.type.underlying(), instr.lhs, instr.rhs,
+                     instr.min ? cast_bound<T>(*instr.min)
+                               : std::numeric_limits<T>::lowest(),
+                     instr.max ? cast_bound<T>(*instr.max)
+                               : std::numeric_limits<T>::max()});
+
+            Shape shapeC = op->getOutput()->getDims();
+            vector<Shape> shapes;
+            for (auto &input : op->getInputs())
+                shapes.emplace_back(input->getDims());
+            collapse_broadcast(shapeC, shapes);
+            const size_t rank = shapeC.size();
+            args.n = op->getOutput()->size();
+            args.inner = shapeC.back();
+            args.outerShape.assign(shapeC.begin(), shapeC.end() - 1);
+            for (auto &shape : shapes)
+            {
+                args.full.push_back(shape.back() != 1);
+                vector<size_t> stride(rank - 1);
+                size_t s = shape.back();
+                for (size_t i = rank - 1; i > 0; --i)
+                {
+                    stride[i - 1] = shape[i - 1] == 1 ? 0 : s;
+                    s *= shape[i - 1];
+                }
+                args.strides.emplace_back(std::move(stride));
+            }
+            return [args]
+            { fusedCompute(args); };
+        }
+
+        Routine prepare(const Operator &_op,
+                        const RuntimeObj *context) const override
+        {
+#define CASE(N) \
+    case N:     \
+        return doPrepare<DT<N>::t>(_op)
+
+            int dataTypeIdx = _op->getDType().getIndex();
+            switch (dataTypeIdx)
+            {
+                CASE(1); // DataType::Float32
+                CASE(12); // DataType::UInt32
+            default:
+                IT_TODO_HALT();
+            }
+        }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            prepare(_op, context)();
+        }
+
+        // A block of the output is only written by the last instruction,
+        // after every instruction has read its block of the inputs.
+        vector<int> getInPlaceInputs(const Operator &op) const override
+        {
+            return sameLayoutInputs(op);
+        }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::FusedElementWise, FusedElementWise,
+                    "FusedElementWise_CPU");
+}; // namespace infini
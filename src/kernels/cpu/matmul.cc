@@ -0,0 +1,320 @@
+#include "operators/matmul.h"
+#include "core/kernel.h"
+#include "utils/operator_utils.h"
+
+namespace infini
+{
+    class BlockedMatmul : public CpuKernelWithoutConfig
+    {
+        // Register tile computed by the micro-kernel.
+        static constexpr size_t MR = 6;
+        static constexpr size_t NR = 8;
+        // Cache blocking: a packed MC x KC block of A stays in L2, a packed
+        // KC x NC panel of B stays in L3 and one KC x NR sliver of it in L1.
+        static constexpr size_t MC = 96;
+        static constexpr size_t KC = 256;
+        static constexpr size_t NC = 512;
+
+        // Strided view of a 2D matrix: element (i, j) is at
+        // ptr[i * rowStride + j * colStride]. Transposition only swaps strides.
+        template <typename T>
+        struct MatrixView
+        {
+            const T *ptr;
+            size_t rowStride, colStride;
+            const T &at(size_t i, size_t j) const
+            {
+                return ptr[i * rowStride + j * colStride];
+            }
+        };
+
+        // Pack an mc x kc block of A into slivers of MR rows, k-major inside a
+        // sliver. Rows beyond mc are zero-padded.
+        template <typename T>
+        static void packA(const MatrixView<T> &a, size_t mc, size_t kc, T *dst)
+        {
+            for (size_t i = 0; i < mc; i += MR)
+            {
+                size_t mr = std::min(MR, mc - i);
+                for (size_t p = 0; p < kc; ++p)
+                {
+                    for (size_t ii = 0; ii < mr; ++ii)
+                        dst[ii] = a.at(i + ii, p);
+                    for (size_t ii = mr; ii < MR; ++ii)
+                        dst[ii] = T(0);
+                    dst += MR;
+                }
+            }
+        }
+
+        // Pack a kc x nc panel of B into slivers of NR columns, k-major inside
+        // a sliver. Columns beyond nc are zero-padded.
+        template <typename T>
+        static void packB(const MatrixView<T> &b, size_t kc, size_t nc, T *dst)
+        {
+            for (size_t j = 0; j < nc; j += NR)
+            {
+                size_t nr = std::min(NR, nc - j);
+                for (size_t p = 0; p < kc; ++p)
+                {
+                    for (size_t jj = 0; jj < nr; ++jj)
+                        dst[jj] = b.at(p, j + jj);
+                    for (size_t jj = nr; jj < NR; ++jj)
+                        dst[jj] = T(0);
+                    dst += NR;
+                }
+            }
+        }
+
+        // Bias and clamp of MatmulObj::Epilogue, applied to C while a tile
+        // is stored for the last time.
+        template <typename T>
+        struct Epilogue
+        {
+            // Bias of the first column handled by the caller; biasStride is
+            // 0 for a scalar bias.
+            const T *bias = nullptr;
+            size_t biasStride = 0;
+            bool hasLo = false, hasHi = false;
+            T lo = T(0), hi = T(0);
+
+            bool active() const { return bias || hasLo || hasHi; }
+            Epilogue shifted(size_t cols) const
+            {
+                Epilogue ret = *this;
+                if (ret.bias)
+                    ret.bias += cols * biasStride;
+                return ret;
+            }
+            T apply(T val, size_t col) const
+            {
+                if (bias)
+                    val += bias[col * biasStride];
+                if (hasLo && val < lo)
+                    val = lo;
+                if (hasHi && val > hi)
+                    val = hi;
+                return val;
+            }
+        };
+
+        // C[0:mr, 0:nr] (+)= packedA sliver * packedB sliver. The full MR x NR
+        // accumulator is kept in registers; only the valid part is written.
+        // With an epilogue the tile is finished before it leaves registers.
+        template <typename T>
+        static void microKernel(size_t kc, const T *a, const T *b, T *c,
+                                size_t ldc, size_t mr, size_t nr,
+                                bool accumulate, const Epilogue<T> *epilogue)
+        {
+            T acc[MR][NR] = {};
+            for (size_t p = 0; p < kc; ++p)
+            {
+                for (size_t i = 0; i < MR; ++i)
+                {
+                    const T ai = a[i];
+#pragma omp simd
+                    for (size_t j = 0; j < NR; ++j)
+                        acc[i][j] += ai * b[j];
+                }
+                a += MR;
+                b += NR;
+            }
+            if (epilogue)
+            {
+                for (size_t i = 0; i < mr; ++i)
+                {
+                    T *ci = c + i * ldc;
+                    for (size_t j = 0; j < nr; ++j)
+                        ci[j] = epilogue->apply(
+                            accumulate ? ci[j] + acc[i][j] : acc[i][j], j);
+                }
+                return;
+            }
+            for (size_t i = 0; i < mr; ++i)
+            {
+                T *ci = c + i * ldc;
+                if (accumulate)
+                    for (size_t j = 0; j < nr; ++j)
+                        ci[j] += acc[i][j];
+                else
+                    for (size_t j = 0; j < nr; ++j)
+                        ci[j] = acc[i][j];
+            }
+        }
+
+        // One MC x NC block of C for a single batch. packedA and packedB are
+        // per-thread scratch buffers of MC * KC and KC * NC elements.
+        template <typename T>
+        static void computeBlock(const MatrixView<T> &a, const MatrixView<T> &b,
+                                 T *c, size_t ldc, size_t mc, size_t nc,
+                                 size_t k, T *packedA, T *packedB,
+                                 const Epilogue<T> &epilogue)
+        {
+            for (size_t pc = 0; pc < k; pc += KC)
+            {
+                size_t kc = std::min(KC, k - pc);
+                const bool last = pc + kc == k && epilogue.active();
+                MatrixView<T> aBlock{&a.at(0, pc), a.rowStride, a.colStride};
+                MatrixView<T> bBlock{&b.at(pc, 0), b.rowStride, b.colStride};
+                packA(aBlock, mc, kc, packedA);
+                packB(bBlock, kc, nc, packedB);
+                for (size_t jr = 0; jr < nc; jr += NR)
+                {
+                    const T *bSliver = packedB + jr * kc;
+                    const Epilogue<T> tileEpilogue = epilogue.shifted(jr);
+                    for (size_t ir = 0; ir < mc; ir += MR)
+                    {
+                        microKernel(kc, packedA + ir * kc, bSliver,
+                                    c + ir * ldc + jr, ldc,
+                                    std::min(MR, mc - ir), std::min(NR, nc - jr),
+                                    pc != 0, last ? &tileEpilogue : nullptr);
+                    }
+                }
+            }
+        }
+
+        // Element offset of every output batch inside `shape`, following the
+        // broadcast rules of MatmulObj::inferShape.
+        static vector<size_t> batchOffsets(const Shape &shape,
+                                           const Shape &batchShape,
+                                           size_t matrixSize)
+        {
+            size_t rank = batchShape.size();
+            Shape padded(rank, 1);
+            std::copy(shape.begin(), shape.end() - 2,
+                      padded.begin() + (rank - (shape.size() - 2)));
+            vector<size_t> stride(rank);
+            size_t s = matrixSize;
+            for (size_t i = rank; i > 0; --i)
+            {
+                stride[i - 1] = padded[i - 1] == 1 ? 0 : s;
+                s *= padded[i - 1];
+            }
+            size_t batch = std::accumulate(batchShape.begin(), batchShape.end(),
+                                           (size_t)1, std::multiplies<size_t>());
+            vector<size_t> offsets(batch);
+            for (size_t b = 0; b < batch; ++b)
+            {
+                size_t rest = b, offset = 0;
+                for (size_t i = rank; i > 0; --i)
+                {
+                    offset += rest % batchShape[i - 1] * stride[i - 1];
+                    rest /= batchShape[i - 1];
+                }
+                offsets[b] = offset;
+            }
+            return offsets;
+        }
+
+        // Everything a matmul needs, extracted from the op once.
+        template <typename T>
+        struct GemmArgs
+        {
+            const T *a, *b;
+            T *c;
+            size_t m, n, k;
+            // A is m x k (k x m if transposed), B is k x n (n x k if
+            // transposed); transposition only swaps the strides.
+            size_t rsA, csA, rsB, csB;
+            // Element offset of every output batch in A and B.
+            vector<size_t> offsetsA, offsetsB;
+            Epilogue<T> epilogue;
+        };
+
+        template <typename T>
+        static void gemm(const GemmArgs<T> &args)
+        {
+            const size_t m = args.m, n = args.n, k = args.k;
+            const size_t batch = args.offsetsA.size();
+            if (k == 0)
+            {
+                for (size_t i = 0; i < batch * m * n; ++i)
+                    args.c[i] = args.epilogue.apply(T(0), i % n);
+                return;
+            }
+            const size_t mBlocks = (m + MC - 1) / MC;
+            const size_t nBlocks = (n + NC - 1) / NC;
+            const long nTasks = batch * mBlocks * nBlocks;
+
+#pragma omp parallel
+            {
+                vector<T> packedA(MC * KC), packedB(KC * NC);
+#pragma omp for schedule(dynamic)
+                for (long task = 0; task < nTasks; ++task)
+                {
+                    size_t b = task / (mBlocks * nBlocks);
+                    size_t ic = task / nBlocks % mBlocks * MC;
+                    size_t jc = task % nBlocks * NC;
+                    MatrixView<T> a{args.a + args.offsetsA[b] + ic * args.rsA,
+                                    args.rsA, args.csA};
+                    MatrixView<T> bv{args.b + args.offsetsB[b] + jc * args.csB,
+                                     args.rsB, args.csB};
+                    computeBlock(a, bv, args.c + b * m * n + ic * n + jc, n,
+                                 std::min(MC, m - ic), std::min(NC, n - jc), k,
+                                 packedA.data(), packedB.data(),
+                                 args.epilogue.shifted(jc));
+                }
+            }
+        }
+
+        template <typename T>
+        static Routine doPrepare(const Operator &_op)
+        {
+            auto op = as<MatmulObj>(_op);
+            GemmArgs<T> args;
+            args.a = op->getInputs(0)->getRawDataPtr<T *>();
+            args.b = op->getInputs(1)->getRawDataPtr<T *>();
+            args.c = op->getOutput()->getRawDataPtr<T *>();
+            args.m = op->getM(), args.n = op->getN(), args.k = op->getK();
+            const bool transA = op->getTransA(), transB = op->getTransB();
+            args.rsA = transA ? 1 : args.k, args.csA = transA ? args.m : 1;
+            args.rsB = transB ? 1 : args.n, args.csB = transB ? args.k : 1;
+
+            auto shapeC = op->getOutput()->getDims();
+            Shape batchShape(shapeC.begin(), shapeC.end() - 2);
+            args.offsetsA = batchOffsets(op->getInputs(0)->getDims(),
+                                         batchShape, args.m * args.k);
+            args.offsetsB = batchOffsets(op->getInputs(1)->getDims(),
+                                         batchShape, args.k * args.n);
+
+            if (auto bias = op->getBias())
+            {
+                args.epilogue.bias = bias->getRawDataPtr<T *>();
+                args.epilogue.biasStride = bias->size() == 1 ? 0 : 1;
+            }
+            const auto &epilogue = op->getEpilogue();
+            args.epilogue.hasLo = epilogue.min.has_value();
+            args.epilogue.hasHi = epilogue.max.has_value();
+            args.epilogue.lo = cast_bound<T>(epilogue.min.value_or(0));
+            args.epilogue.hi = cast_bound<T>(epilogue.max.value_or(0));
+            return [args]
+            { gemm(args); };
+        }
+
+        Routine prepare(const Operator &_op,
+                        const RuntimeObj *context) const override
+        {
+#define CASE(N) \
+    case N:     \
+        return doPrepare<DT<N>::t>(_op)
+
+            int dataTypeIdx = _op->getDType().getIndex();
+            switch (dataTypeIdx)
+            {
+                CASE(1); // DataType::Float32
+                CASE(12); // DataType::UInt32
+            default:
+                IT_TODO_HALT();
+            }
+        }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            prepare(_op, context)();
+        }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::MatMul, BlockedMatmul,
+                    "MatmulBlocked_CPU");
+}; // namespace infini
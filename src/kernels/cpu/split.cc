@@ -0,0 +1,70 @@
+#include "operators/split.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+class BlockCopySplit : public CpuKernelWithoutConfig {
+    static constexpr size_t parallelThreshold = 1 << 17;
+
+    // Byte layout of one split, resolved once: the mirror of a concat.
+    struct SplitArgs {
+        const uint8_t *in;
+        size_t outer, rowBytes, totalBytes;
+        // Bytes each output takes per outer index, where they start in the
+        // input row, and where they go.
+        vector<size_t> blockBytes, srcOffset;
+        vector<uint8_t *> dstPtrs;
+    };
+
+    static void splitBlocks(const SplitArgs &args) {
+        const size_t nOutputs = args.dstPtrs.size();
+        const long nTasks = args.outer * nOutputs;
+#pragma omp parallel for if (args.totalBytes > parallelThreshold)
+        for (long task = 0; task < nTasks; ++task) {
+            size_t o = task / nOutputs, i = task % nOutputs;
+            if (args.blockBytes[i] == 0)
+                continue;
+            std::memcpy(args.dstPtrs[i] + o * args.blockBytes[i],
+                        args.in + o * args.rowBytes + args.srcOffset[i],
+                        args.blockBytes[i]);
+        }
+    }
+
+    Routine prepare(const Operator &_op,
+                    const RuntimeObj *context) const override {
+        auto op = as<SplitObj>(_op);
+        auto input = op->getInputs(0);
+        auto dim = op->getDim();
+        const auto &inDim = input->getDims();
+
+        SplitArgs args;
+        args.in = input->getRawDataPtr<uint8_t *>();
+        args.outer = 1;
+        for (int i = 0; i < dim; ++i)
+            args.outer *= inDim[i];
+        if (args.outer == 0)
+            return [] {};
+        args.totalBytes = input->getBytes();
+        args.rowBytes = args.totalBytes / args.outer;
+
+        size_t offset = 0;
+        for (auto &output : op->getOutputs()) {
+            args.blockBytes.emplace_back(output->getBytes() / args.outer);
+            args.srcOffset.emplace_back(offset);
+            args.dstPtrs.emplace_back(output->getRawDataPtr<uint8_t *>());
+            offset += args.blockBytes.back();
+        }
+        IT_ASSERT(offset == args.rowBytes);
+        return [args] { splitBlocks(args); };
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        prepare(_op, context)();
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Split, BlockCopySplit,
+                "SplitBlockCopy_CPU");
+
+} // namespace infini
@@ -1,60 +1,284 @@
 #include "operators/transpose.h"
 #include "core/kernel.h"
+#if defined(__SSE2__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
 
 namespace infini {
 
-inline Shape idx2Pos(const Shape &shape, size_t idx) {
-    Shape pos = Shape(shape.size(), 0);
-    auto rest = idx, curDimId = shape.size() - 1;
-    while (rest > 0) {
-        pos[curDimId] = rest % shape[curDimId];
-        rest /= shape[curDimId];
-        curDimId--;
+class TiledTranspose : public CpuKernelWithoutConfig {
+    // Edge of the square tile used for the innermost swapped pair of
+    // dimensions. Two 64x64 tiles of 4-byte elements fit in L1.
+    static constexpr size_t tileSize = 64;
+    static constexpr size_t parallelThreshold = 1 << 15;
+
+    // Drop unit dimensions and merge input dimensions that stay adjacent
+    // under the permutation, e.g. [a,b,c,d] with perm [2,3,0,1] becomes
+    // [ab,cd] with perm [1,0].
+    static void coalesce(const Shape &inDim, const vector<int> &perm,
+                         Shape &shape, vector<int> &newPerm) {
+        int rank = inDim.size();
+        vector<int> compact(rank, -1);
+        Shape shape1;
+        for (int i = 0; i < rank; ++i)
+            if (inDim[i] != 1) {
+                compact[i] = shape1.size();
+                shape1.emplace_back(inDim[i]);
+            }
+        vector<int> perm1;
+        for (auto p : perm)
+            if (compact[p] >= 0)
+                perm1.emplace_back(compact[p]);
+
+        // Runs of consecutive input dimensions in output order.
+        vector<int> groupStart, groupOfDim(shape1.size());
+        for (size_t j = 0; j < perm1.size(); ++j) {
+            if (j == 0 || perm1[j] != perm1[j - 1] + 1)
+                groupStart.emplace_back(perm1[j]);
+            groupOfDim[perm1[j]] = groupStart.size() - 1;
+        }
+        shape.clear();
+        newPerm.assign(groupStart.size(), 0);
+        vector<int> groupToInput(groupStart.size());
+        for (size_t i = 0; i < shape1.size(); ++i) {
+            int g = groupOfDim[i];
+            if ((int)i == groupStart[g]) {
+                groupToInput[g] = shape.size();
+                shape.emplace_back(shape1[i]);
+            } else {
+                shape.back() *= shape1[i];
+            }
+        }
+        for (size_t g = 0; g < groupStart.size(); ++g)
+            newPerm[g] = groupToInput[g];
+        if (shape.empty()) {
+            shape = {1};
+            newPerm = {0};
+        }
     }
-    return pos;
-}
 
-class NaiveTranspose : public CpuKernelWithoutConfig {
+    // dst[j * ldd + i] = src[i * lds + j] for a rows x cols block.
     template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+    static void transposeTile(const T *src, size_t lds, T *dst, size_t ldd,
+                              size_t rows, size_t cols) {
+        size_t i = 0;
+#if defined(__AVX__)
+        if constexpr (sizeof(T) == 4) {
+            for (; i + 8 <= rows; i += 8) {
+                size_t j = 0;
+                for (; j + 8 <= cols; j += 8)
+                    transpose8x8(reinterpret_cast<const float *>(src + i * lds + j),
+                                 lds, reinterpret_cast<float *>(dst + j * ldd + i),
+                                 ldd);
+                for (; j < cols; ++j)
+                    for (size_t ii = i; ii < i + 8; ++ii)
+                        dst[j * ldd + ii] = src[ii * lds + j];
+            }
+        }
+#elif defined(__SSE2__)
+        if constexpr (sizeof(T) == 4) {
+            for (; i + 4 <= rows; i += 4) {
+                size_t j = 0;
+                for (; j + 4 <= cols; j += 4)
+                    transpose4x4(reinterpret_cast<const float *>(src + i * lds + j),
+                                 lds, reinterpret_cast<float *>(dst + j * ldd + i),
+                                 ldd);
+                for (; j < cols; ++j)
+                    for (size_t ii = i; ii < i + 4; ++ii)
+                        dst[j * ldd + ii] = src[ii * lds + j];
+            }
+        }
+#endif
+        for (; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                dst[j * ldd + i] = src[i * lds + j];
+    }
+
+#if defined(__AVX__)
+    static void transpose8x8(const float *src, size_t lds, float *dst,
+                             size_t ldd) {
+        __m256 r0 = _mm256_loadu_ps(src + 0 * lds);
+        __m256 r1 = _mm256_loadu_ps(src + 1 * lds);
+        __m256 r2 = _mm256_loadu_ps(src + 2 * lds);
+        __m256 r3 = _mm256_loadu_ps(src + 3 * lds);
+        __m256 r4 = _mm256_loadu_ps(src + 4 * lds);
+        __m256 r5 = _mm256_loadu_ps(src + 5 * lds);
+        __m256 r6 = _mm256_loadu_ps(src + 6 * lds);
+        __m256 r7 = _mm256_loadu_ps(src + 7 * lds);
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+        __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+        __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+        __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+        __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+        r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        r4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        r5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        r6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        r7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_storeu_ps(dst + 0 * ldd, _mm256_permute2f128_ps(r0, r4, 0x20));
+        _mm256_storeu_ps(dst + 1 * ldd, _mm256_permute2f128_ps(r1, r5, 0x20));
+        _mm256_storeu_ps(dst + 2 * ldd, _mm256_permute2f128_ps(r2, r6, 0x20));
+        _mm256_storeu_ps(dst + 3 * ldd, _mm256_permute2f128_ps(r3, r7, 0x20));
+        _mm256_storeu_ps(dst + 4 * ldd, _mm256_permute2f128_ps(r0, r4, 0x31));
+        _mm256_storeu_ps(dst + 5 * ldd, _mm256_permute2f128_ps(r1, r5, 0x31));
+        _mm256_storeu_ps(dst + 6 * ldd, _mm256_permute2f128_ps(r2, r6, 0x31));
+        _mm256_storeu_ps(dst + 7 * ldd, _mm256_permute2f128_ps(r3, r7, 0x31));
+    }
+#elif defined(__SSE2__)
+    static void transpose4x4(const float *src, size_t lds, float *dst,
+                             size_t ldd) {
+        __m128 r0 = _mm_loadu_ps(src + 0 * lds);
+        __m128 r1 = _mm_loadu_ps(src + 1 * lds);
+        __m128 r2 = _mm_loadu_ps(src + 2 * lds);
+        __m128 r3 = _mm_loadu_ps(src + 3 * lds);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(dst + 0 * ldd, r0);
+        _mm_storeu_ps(dst + 1 * ldd, r1);
+        _mm_storeu_ps(dst + 2 * ldd, r2);
+        _mm_storeu_ps(dst + 3 * ldd, r3);
+    }
+#endif
+
+    // Layout of one transpose, resolved once: a batch of outer indices, each
+    // of which is either a contiguous row of `cols` elements (the innermost
+    // dimension is kept) or a rows x cols matrix to transpose.
+    template <typename T> struct TransposeArgs {
+        const T *in;
+        T *out;
+        size_t n;
+        // Outer dimensions with their strides in the input and the output.
+        vector<size_t> outerShape, outerInStride, outerOutStride;
+        size_t rows, cols, lds, ldd;
+    };
+
+    template <typename T>
+    static void outerOffsets(const TransposeArgs<T> &args, size_t idx,
+                             size_t &inOffset, size_t &outOffset) {
+        inOffset = outOffset = 0;
+        for (size_t d = args.outerShape.size(); d > 0; --d) {
+            size_t i = idx % args.outerShape[d - 1];
+            idx /= args.outerShape[d - 1];
+            inOffset += i * args.outerInStride[d - 1];
+            outOffset += i * args.outerOutStride[d - 1];
+        }
+    }
+
+    template <typename T> static void copyRows(const TransposeArgs<T> &args) {
+        const long nRows = args.n / args.cols;
+#pragma omp parallel for if (args.n > parallelThreshold)
+        for (long row = 0; row < nRows; ++row) {
+            size_t inOffset, outOffset;
+            outerOffsets(args, row, inOffset, outOffset);
+            std::copy(args.in + inOffset, args.in + inOffset + args.cols,
+                      args.out + outOffset);
+        }
+    }
+
+    template <typename T>
+    static void transposeTiles(const TransposeArgs<T> &args) {
+        const size_t rows = args.rows, cols = args.cols;
+        const size_t rowTiles = (rows + tileSize - 1) / tileSize;
+        const long nTasks = args.n / (rows * cols) * rowTiles;
+#pragma omp parallel for if (args.n > parallelThreshold)
+        for (long task = 0; task < nTasks; ++task) {
+            size_t inOffset, outOffset;
+            outerOffsets(args, task / rowTiles, inOffset, outOffset);
+            size_t i0 = task % rowTiles * tileSize;
+            size_t tileRows = std::min(tileSize, rows - i0);
+            for (size_t j0 = 0; j0 < cols; j0 += tileSize) {
+                transposeTile(args.in + inOffset + i0 * args.lds + j0,
+                              args.lds,
+                              args.out + outOffset + j0 * args.ldd + i0,
+                              args.ldd, tileRows, std::min(tileSize, cols - j0));
+            }
+        }
+    }
+
+    template <typename T> static Routine doPrepare(const Operator &_op) {
         auto op = as<TransposeObj>(_op);
         auto inputs = op->getInputs(), outputs = op->getOutputs();
-        const auto &inDim = inputs[0]->getDims();
-        const auto &perm = op->getPermute();
-
-        size_t inSize = inputs[0]->size();
-        auto inPtr = inputs[0]->getRawDataPtr<T *>(),
-             outPtr = outputs[0]->getRawDataPtr<T *>();
-        // #pragma omp parallel for
-        for (size_t inIdx = 0; inIdx < inSize; ++inIdx) {
-            auto posInput = idx2Pos(inDim, inIdx);
-            int outIdx = 0;
-            for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
-                outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
-            }
-            outPtr[outIdx] = inPtr[inIdx];
+        TransposeArgs<T> args;
+        args.in = inputs[0]->getRawDataPtr<T *>();
+        args.out = outputs[0]->getRawDataPtr<T *>();
+        args.n = inputs[0]->size();
+        // A zero-sized tensor has nothing to move, and no tiles to divide by.
+        if (args.n == 0)
+            return [] {};
+
+        Shape shape;
+        vector<int> perm;
+        coalesce(inputs[0]->getDims(), op->getPermute(), shape, perm);
+        const int rank = shape.size();
+        if (rank == 1)
+            return [args] { std::copy(args.in, args.in + args.n, args.out); };
+
+        // Strides of every input dimension in the input and in the output.
+        vector<size_t> inStride(rank), outStride(rank);
+        size_t sIn = 1, sOut = 1;
+        for (int i = rank - 1; i >= 0; --i) {
+            inStride[i] = sIn;
+            sIn *= shape[i];
+            outStride[perm[i]] = sOut;
+            sOut *= shape[perm[i]];
+        }
+        auto addOuterDim = [&](int dim) {
+            args.outerShape.emplace_back(shape[dim]);
+            args.outerInStride.emplace_back(inStride[dim]);
+            args.outerOutStride.emplace_back(outStride[dim]);
+        };
+
+        if (perm[rank - 1] == rank - 1) {
+            // The innermost dimension is kept: copy contiguous rows, walking
+            // the other dimensions in output order.
+            for (int j = 0; j < rank - 1; ++j)
+                addOuterDim(perm[j]);
+            args.cols = shape[rank - 1];
+            return [args] { copyRows(args); };
         }
+
+        // The innermost swapped pair: dimension `a` becomes contiguous in the
+        // output and dimension `b` is contiguous in the input. All other
+        // dimensions are outer loops.
+        const int a = perm[rank - 1], b = rank - 1;
+        args.rows = shape[a], args.cols = shape[b];
+        args.lds = inStride[a], args.ldd = outStride[b];
+        for (int i = 0; i < rank; ++i)
+            if (i != a && i != b)
+                addOuterDim(i);
+        return [args] { transposeTiles(args); };
     }
 
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
-
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
+    Routine prepare(const Operator &_op,
+                    const RuntimeObj *context) const override {
+        // Transposition only moves elements, so dispatch on the element width
+        // and support every fixed-size data type.
+        switch (_op->getDType().getSize()) {
+        case 1:
+            return doPrepare<uint8_t>(_op);
+        case 2:
+            return doPrepare<uint16_t>(_op);
+        case 4:
+            return doPrepare<uint32_t>(_op);
+        case 8:
+            return doPrepare<uint64_t>(_op);
         default:
             IT_TODO_HALT();
         }
     }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        prepare(_op, context)();
+    }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Transpose, NaiveTranspose,
-                "TransposeNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, TiledTranspose,
+                "TransposeTiled_CPU");
 
 } // namespace infini
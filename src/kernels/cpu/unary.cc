@@ -1,102 +1,173 @@
 #include "operators/unary.h"
 #include "core/kernel.h"
+#include "utils/operator_utils.h"
 
 namespace infini
 {
+    constexpr size_t unaryParallelThreshold = 1 << 15;
+    constexpr size_t unaryChunkSize = 1 << 14;
+
+    // Apply `op` element by element in contiguous chunks across threads. Each
+    // element is read before it is written, so `in` may alias `out` and the
+    // kernels can run in place.
+    template <typename T, typename Op>
+    void unaryCompute(const T *in, T *out, size_t n, const Op &op)
+    {
+        const long nChunks = (n + unaryChunkSize - 1) / unaryChunkSize;
+#pragma omp parallel for if (n > unaryParallelThreshold)
+        for (long i = 0; i < nChunks; ++i)
+        {
+            const size_t begin = i * unaryChunkSize;
+            const size_t end = std::min(begin + unaryChunkSize, n);
+#pragma omp simd
+            for (size_t j = begin; j < end; ++j)
+                out[j] = op(in[j]);
+        }
+    }
+
     class NativeUnary : public CpuKernelWithoutConfig
     {
         template <typename T>
-        static T reluCompute(T val)
+        struct ReluCompute
         {
-            return std::max(T(0), val);
-        }
+            T operator()(T val) const { return val > T(0) ? val : T(0); }
+        };
 
         template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        static Routine doPrepare(const Operator &_op)
         {
             auto op = as<UnaryObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
-
-            auto outDim = op->getOutput()->getDims();
             auto n = op->getOutput()->size();
 
-            T (*_doCompute)
-            (T val);
             switch (op->getOpType().underlying())
             {
             case OpType::Relu:
-                _doCompute = reluCompute<T>;
-                break;
+                return [=]
+                { unaryCompute(inptr, outptr, n, ReluCompute<T>()); };
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t offset = 0; offset < n; offset++)
-            {
-                outptr[offset] = _doCompute(inptr[offset]);
-            }
         }
 
-        void compute(const Operator &_op,
-                     const RuntimeObj *context) const override
+        Routine prepare(const Operator &_op,
+                        const RuntimeObj *context) const override
         {
 #define CASE(N) \
     case N:     \
-        doCompute<DT<N>::t>(_op, context)
+        return doPrepare<DT<N>::t>(_op)
 
             int dataTypeIdx = _op->getDType().getIndex();
             switch (dataTypeIdx)
             {
                 CASE(1); // DataType::Float32
-                break;
                 CASE(12); // DataType::UInt32
-                break;
             default:
                 IT_TODO_HALT();
             }
         }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            prepare(_op, context)();
+        }
+
+        vector<int> getInPlaceInputs(const Operator &op) const override
+        {
+            return sameLayoutInputs(op);
+        }
     };
 
     class Clip : public CpuKernelWithoutConfig
     {
+        // One functor per combination of bounds, so the per-element loop never
+        // tests whether a bound is present.
+        template <typename T>
+        struct ClipMin
+        {
+            T lo;
+            T operator()(T val) const { return val < lo ? lo : val; }
+        };
+
+        template <typename T>
+        struct ClipMax
+        {
+            T hi;
+            T operator()(T val) const { return val > hi ? hi : val; }
+        };
+
         template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        struct ClipBoth
+        {
+            T lo, hi;
+            T operator()(T val) const
+            {
+                val = val < lo ? lo : val;
+                return val > hi ? hi : val;
+            }
+        };
+
+        // The bounds are resolved once, so the routine only runs the functor.
+        template <typename T>
+        static Routine doPrepare(const Operator &_op)
         {
             auto op = as<ClipObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
             auto minValue = op->getMin();
             auto maxValue = op->getMax();
-
             auto n = op->getOutput()->size();
-            for (size_t offset = 0; offset < n; offset++)
+
+            if (minValue && maxValue)
+            {
+                ClipBoth<T> clip{cast_bound<T>(*minValue),
+                                 cast_bound<T>(*maxValue)};
+                return [=]
+                { unaryCompute(inptr, outptr, n, clip); };
+            }
+            if (minValue)
             {
-                auto val = *inptr++;
-                *outptr++ = (minValue && val < *minValue)   ? *minValue
-                            : (maxValue && val > *maxValue) ? *maxValue
-                                                            : val;
+                ClipMin<T> clip{cast_bound<T>(*minValue)};
+                return [=]
+                { unaryCompute(inptr, outptr, n, clip); };
             }
+            if (maxValue)
+            {
+                ClipMax<T> clip{cast_bound<T>(*maxValue)};
+                return [=]
+                { unaryCompute(inptr, outptr, n, clip); };
+            }
+            if (inptr == outptr)
+                return [] {};
+            return [=]
+            { std::copy(inptr, inptr + n, outptr); };
         }
 
-        void compute(const Operator &_op,
-                     const RuntimeObj *context) const override
+        Routine prepare(const Operator &_op,
+                        const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
             int dataTypeIdx = _op->getDType().getIndex();
             switch (dataTypeIdx)
             {
                 CASE(1); // DataType::Float32
-                break;
                 CASE(12); // DataType::UInt32
-                break;
             default:
                 IT_TODO_HALT();
             }
         }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            prepare(_op, context)();
+        }
+
+        vector<int> getInPlaceInputs(const Operator &op) const override
+        {
+            return sameLayoutInputs(op);
+        }
     };
 
     REGISTER_KERNEL(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU");
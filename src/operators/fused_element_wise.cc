@@ -0,0 +1,84 @@
+#include "operators/fused_element_wise.h"
+#include "utils/operator_utils.h"
+
+namespace infini
+{
+    FusedElementWiseObj::FusedElementWiseObj(GraphObj *graph, TensorVec inputs,
+                                             Tensor output,
+                                             vector<Instruction> program)
+        : OperatorObj(OpType::FusedElementWise, inputs, {output}),
+          program(std::move(program))
+    {
+        IT_ASSERT(checkValid(graph));
+    }
+
+    bool FusedElementWiseObj::isFusible(OpType type)
+    {
+        switch (type.underlying())
+        {
+        case OpType::Add:
+        case OpType::Sub:
+        case OpType::Mul:
+        case OpType::Div:
+        case OpType::Relu:
+        case OpType::Clip:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    optional<vector<Shape>> FusedElementWiseObj::inferShape(const TensorVec &inputs)
+    {
+        if (program.empty())
+            return {};
+        vector<Shape> values;
+        for (auto &input : inputs)
+            values.emplace_back(input->getDims());
+        for (auto &instr : program)
+        {
+            const int n = values.size();
+            if (instr.lhs < 0 || instr.lhs >= n || instr.rhs >= n)
+                return {};
+            if (instr.rhs < 0)
+                values.emplace_back(values[instr.lhs]);
+            else
+                values.emplace_back(
+                    infer_broadcast(values[instr.lhs], values[instr.rhs]));
+        }
+        return {{values.back()}};
+    }
+
+    vector<int> FusedElementWiseObj::getOpAttrVector() const
+    {
+        vector<int> ret{type.underlying()};
+        for (auto &instr : program)
+        {
+            ret.insert(ret.end(), {instr.type.underlying(), instr.lhs, instr.rhs});
+            append_float_attr(ret, instr.min);
+            append_float_attr(ret, instr.max);
+        }
+        return ret;
+    }
+
+    std::string FusedElementWiseObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(";
+        for (size_t i = 0; i < program.size(); ++i)
+        {
+            auto &instr = program[i];
+            os << "%" << inputs.size() + i << "=" << instr.type.toString()
+               << "(%" << instr.lhs;
+            if (instr.rhs >= 0)
+                os << ",%" << instr.rhs;
+            os << "),";
+        }
+        for (size_t i = 0; i < inputs.size(); ++i)
+            os << "input" << i << "=" << inputs[i]->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ")";
+        return os.str();
+    }
+
+}; // namespace infini
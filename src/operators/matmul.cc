@@ -5,9 +5,10 @@ namespace infini
 {
 
     MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA,
-                         bool transB)
-        : OperatorObj(OpType::MatMul, TensorVec{A, B}, {C}),
-          transA(transA), transB(transB)
+                         bool transB, Tensor bias, Epilogue epilogue)
+        : OperatorObj(OpType::MatMul,
+                      bias ? TensorVec{A, B, bias} : TensorVec{A, B}, {C}),
+          transA(transA), transB(transB), epilogue(epilogue)
     {
         IT_ASSERT(checkValid(graph));
     }
@@ -18,10 +19,25 @@ namespace infini
         os << "Matmul([" << (transA ? "A^T" : "A") << "," << (transB ? "B^T" : "B]")
            << ",A=" << inputs[0]->getGuid()
            << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
-           << ",mnk=[" << m << "," << n << "," << k << "])";
+           << ",mnk=[" << m << "," << n << "," << k << "]";
+        if (inputs.size() > 2)
+            os << ",bias=" << inputs[2]->getGuid();
+        if (epilogue.min)
+            os << ",min=" << *epilogue.min;
+        if (epilogue.max)
+            os << ",max=" << *epilogue.max;
+        os << ")";
         return os.str();
     }
 
+    vector<int> MatmulObj::getOpAttrVector() const
+    {
+        vector<int> ret{type.underlying(), transA, transB};
+        append_float_attr(ret, epilogue.min);
+        append_float_attr(ret, epilogue.max);
+        return ret;
+    }
+
     optional<vector<Shape>> MatmulObj::inferShape(const TensorVec &inputs)
     {
         // =================================== 作业 ===================================
@@ -44,6 +60,16 @@ namespace infini
         k = kA;
         ret.emplace_back(m);
         ret.emplace_back(n);
+        if (inputs.size() > 2)
+        {
+            // The bias is a single row broadcast over the output.
+            auto shapeBias = inputs[2]->getDims();
+            size_t biasSize = inputs[2]->size();
+            if (shapeBias.size() > ret.size() ||
+                (biasSize != 1 &&
+                 (biasSize != (size_t)n || shapeBias.back() != n)))
+                return {};
+        }
         return {{ret}};
     }
 
@@ -0,0 +1,54 @@
+#include "operators/split.h"
+#include "utils/operator_utils.h"
+
+namespace infini {
+SplitObj::SplitObj(GraphObj *graph, Tensor input,
+                   std::optional<TensorVec> outputs, int _dim,
+                   vector<int> sizes)
+    : OperatorObj(OpType::Split, {input},
+                  outputs ? *outputs : TensorVec(sizes.size(), nullptr)),
+      sizes(std::move(sizes)) {
+    dim = get_real_axis(_dim, input->getRank());
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>> SplitObj::inferShape(const TensorVec &inputs) {
+    Shape dims = inputs[0]->getDims();
+    int total = 0;
+    for (int size : sizes) {
+        if (size < 0)
+            return {};
+        total += size;
+    }
+    if (sizes.empty() || total != dims[dim])
+        return {};
+    vector<Shape> ret;
+    for (int size : sizes) {
+        dims[dim] = size;
+        ret.emplace_back(dims);
+    }
+    return {ret};
+}
+
+vector<int> SplitObj::getOpAttrVector() const {
+    vector<int> ret{type.underlying(), dim};
+    ret.insert(ret.end(), sizes.begin(), sizes.end());
+    return ret;
+}
+
+std::string SplitObj::toString() const {
+    std::ostringstream os;
+    os << "Split[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "dim=" << dim << ",";
+    os << "sizes=" << vecToString(sizes) << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "output=";
+    for (auto output : outputs)
+        os << output->getGuid() << ",";
+    os << ")";
+    return os.str();
+}
+
+} // namespace infini
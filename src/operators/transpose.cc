@@ -44,6 +44,13 @@ namespace infini
         return {{output_dim}};
     }
 
+    vector<int> TransposeObj::getOpAttrVector() const
+    {
+        vector<int> ret = transposePermute;
+        ret.insert(ret.begin(), type.underlying());
+        return ret;
+    }
+
     std::string TransposeObj::toString() const
     {
         std::ostringstream os;
@@ -1,5 +1,6 @@
 #include "utils/operator_utils.h"
 #include "core/runtime.h"
+#include <cstring>
 
 namespace infini {
 
@@ -73,6 +74,115 @@ size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
     return ans;
 }
 
+void collapse_broadcast(Shape &output, vector<Shape> &inputs) {
+    size_t rank = output.size();
+    for (auto &input : inputs) {
+        IT_ASSERT(input.size() <= rank);
+        input.insert(input.begin(), rank - input.size(), 1);
+    }
+    Shape newOutput;
+    vector<Shape> newInputs(inputs.size());
+    vector<bool> lastFull(inputs.size());
+    for (size_t i = 0; i < rank; ++i) {
+        if (output[i] == 1)
+            continue;
+        bool mergeable = !newOutput.empty();
+        for (size_t j = 0; j < inputs.size() && mergeable; ++j)
+            mergeable = lastFull[j] == (inputs[j][i] == output[i]);
+        if (mergeable) {
+            newOutput.back() *= output[i];
+            for (size_t j = 0; j < inputs.size(); ++j)
+                newInputs[j].back() *= inputs[j][i];
+        } else {
+            newOutput.emplace_back(output[i]);
+            for (size_t j = 0; j < inputs.size(); ++j) {
+                newInputs[j].emplace_back(inputs[j][i]);
+                lastFull[j] = inputs[j][i] == output[i];
+            }
+        }
+    }
+    if (newOutput.empty()) {
+        newOutput.emplace_back(1);
+        for (auto &input : newInputs)
+            input.emplace_back(1);
+    }
+    output = std::move(newOutput);
+    inputs = std::move(newInputs);
+}
+
+vector<int> compose_permutation(const vector<int> &first,
+                                const vector<int> &second) {
+    IT_ASSERT(first.size() == second.size());
+    // Output axis i of `second` reads axis second[i] of its input, which is
+    // axis first[second[i]] of the original tensor.
+    vector<int> ret(second.size());
+    for (size_t i = 0; i < second.size(); ++i)
+        ret[i] = first[second[i]];
+    return ret;
+}
+
+vector<int> inverse_permutation(const vector<int> &perm) {
+    vector<int> ret(perm.size());
+    for (size_t i = 0; i < perm.size(); ++i)
+        ret[perm[i]] = i;
+    return ret;
+}
+
+bool is_identity_permutation(const vector<int> &perm) {
+    for (size_t i = 0; i < perm.size(); ++i)
+        if (perm[i] != (int)i)
+            return false;
+    return true;
+}
+
+bool is_last_two_axes_swap(const vector<int> &perm) {
+    const int rank = perm.size();
+    if (rank < 2 || perm[rank - 2] != rank - 1 || perm[rank - 1] != rank - 2)
+        return false;
+    for (int i = 0; i < rank - 2; ++i)
+        if (perm[i] != i)
+            return false;
+    return true;
+}
+
+void append_float_attr(vector<int> &attrs, std::optional<float> value) {
+    attrs.emplace_back(value.has_value());
+    int bits = 0;
+    if (value)
+        std::memcpy(&bits, &*value, sizeof(bits));
+    attrs.emplace_back(bits);
+}
+
+bool is_exact_conversion(DataType from, DataType to) {
+    if (from == to)
+        return true;
+    static const std::map<int, vector<DataType>> wider{
+        {DataType::Int8.getIndex(),
+         {DataType::Int16, DataType::Int32, DataType::Int64, DataType::Float16,
+          DataType::Float32, DataType::Double}},
+        {DataType::UInt8.getIndex(),
+         {DataType::Int16, DataType::UInt16, DataType::Int32, DataType::UInt32,
+          DataType::Int64, DataType::UInt64, DataType::Float16,
+          DataType::Float32, DataType::Double}},
+        {DataType::Int16.getIndex(),
+         {DataType::Int32, DataType::Int64, DataType::Float32,
+          DataType::Double}},
+        {DataType::UInt16.getIndex(),
+         {DataType::Int32, DataType::UInt32, DataType::Int64, DataType::UInt64,
+          DataType::Float32, DataType::Double}},
+        {DataType::Int32.getIndex(), {DataType::Int64, DataType::Double}},
+        {DataType::UInt32.getIndex(),
+         {DataType::Int64, DataType::UInt64, DataType::Double}},
+        {DataType::Float16.getIndex(), {DataType::Float32, DataType::Double}},
+        {DataType::BFloat16.getIndex(), {DataType::Float32, DataType::Double}},
+        {DataType::Float32.getIndex(), {DataType::Double}},
+    };
+    auto it = wider.find(from.getIndex());
+    return it != wider.end() &&
+           std::find(it->second.begin(), it->second.end(), to) !=
+               it->second.end();
+}
+
 std::string device_to_str(Device device) {
     std::string deviceStr;
     switch (device) {
@@ -0,0 +1,92 @@
+#include "utils/thread_pool.h"
+#include "core/common.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace infini {
+
+namespace {
+// The pool and index of the worker running on this thread, if any.
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+} // namespace
+
+ThreadPool::ThreadPool(size_t numThreads, int intraOpThreads)
+    : intraOpThreads(intraOpThreads) {
+    IT_ASSERT(numThreads > 0 && intraOpThreads > 0);
+    for (size_t i = 0; i < numThreads; ++i)
+        workers.emplace_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < numThreads; ++i)
+        workers[i]->thread = std::thread([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker : workers)
+        worker->thread.join();
+}
+
+void ThreadPool::submit(Task task) {
+    size_t id = currentPool == this
+                    ? currentWorker
+                    : nextWorker.fetch_add(1) % workers.size();
+    {
+        std::lock_guard<std::mutex> lock(workers[id]->mutex);
+        workers[id]->tasks.emplace_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++pending;
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::popTask(size_t id, Task &task) {
+    {
+        auto &own = *workers[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); ++i) {
+        auto &victim = *workers[(id + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t id) {
+    currentPool = this;
+    currentWorker = id;
+#ifdef _OPENMP
+    omp_set_num_threads(intraOpThreads);
+#endif
+    Task task;
+    while (true) {
+        if (popTask(id, task)) {
+            --pending;
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return stopping || pending > 0; });
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+} // namespace infini
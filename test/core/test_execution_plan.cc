@@ -0,0 +1,132 @@
+#include "core/execution_plan.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    TEST(ExecutionPlan, RunRepeatedly)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({3}, DataType::Float32);
+        auto add = g->addOp<AddObj>(a, b, nullptr);
+        auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+        g->dataMalloc();
+
+        auto plan = runtime->compile(g);
+        ASSERT_EQ(plan->getSteps().size(), 2);
+        EXPECT_EQ(plan->getSteps()[0].op, add);
+        EXPECT_EQ(plan->getSteps()[1].op, relu);
+
+        // The plan reads through the bound pointers, so new input data is
+        // picked up without recompiling.
+        float *aPtr = a->getRawDataPtr<float *>();
+        float *bPtr = b->getRawDataPtr<float *>();
+        std::fill(aPtr, aPtr + 6, 1.f);
+        std::copy_n(vector<float>{-2, 0, 2}.begin(), 3, bPtr);
+        plan->run();
+        EXPECT_TRUE(
+            relu->getOutput()->equalData(vector<float>{0, 1, 3, 0, 1, 3}));
+
+        std::copy_n(vector<float>{1, 2, 3, -4, -5, -6}.begin(), 6, aPtr);
+        plan->run();
+        EXPECT_TRUE(
+            relu->getOutput()->equalData(vector<float>{0, 2, 5, 0, 0, 0}));
+    }
+
+    TEST(ExecutionPlan, CachedByRun)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({6}, DataType::Float32);
+        auto relu = g->addOp<ReluObj>(x, nullptr);
+        g->dataMalloc();
+        EXPECT_EQ(g->getCachedPlan(runtime.get()), nullptr);
+        runtime->run(g);
+        auto plan = g->getCachedPlan(runtime.get());
+        ASSERT_NE(plan, nullptr);
+        runtime->run(g);
+        EXPECT_EQ(g->getCachedPlan(runtime.get()), plan);
+
+        // Editing the graph drops the plan.
+        g->addOp<ReluObj>(relu->getOutput(), nullptr);
+        EXPECT_EQ(g->getCachedPlan(runtime.get()), nullptr);
+    }
+
+    TEST(ExecutionPlan, MemoryDependencies)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({8}, DataType::Float32);
+        auto r1 = g->addOp<ReluObj>(x, nullptr);
+        auto r2 = g->addOp<ReluObj>(x, nullptr);
+        auto add = g->addOp<AddObj>(r1->getOutput(), r2->getOutput(), nullptr);
+        g->dataMalloc();
+        // The output of r2 reuses the memory of x, which r1 reads.
+        EXPECT_EQ(r2->getOutput()->getRawDataPtr<void *>(),
+                  x->getRawDataPtr<void *>());
+        EXPECT_EQ(g->getMemoryDependencies(r2), OpVec{r1});
+        EXPECT_TRUE(g->getMemoryDependencies(r1).empty());
+        // r1 and r2 precede add through its inputs already.
+        EXPECT_TRUE(g->getMemoryDependencies(add).empty());
+    }
+
+    TEST(ExecutionPlan, MemoryDependenciesOfChain)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor t = g->addTensor({8}, DataType::Float32);
+        for (int i = 0; i < 64; ++i)
+            t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+        g->dataMalloc();
+        // Each Relu runs in place after its producer, which orders it after
+        // every earlier reader of the same memory.
+        for (auto &op : g->getOperators())
+            EXPECT_TRUE(g->getMemoryDependencies(op).empty());
+    }
+
+    TEST(ExecutionPlan, RunOnThreadPool)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 16, 8}, DataType::Float32);
+        TensorVec heads;
+        for (int h = 0; h < 4; ++h)
+        {
+            auto t = g->addOp<TransposeObj>(x, nullptr, Shape{0, 2, 1});
+            auto add = g->addOp<AddObj>(t->getOutput(), t->getOutput(),
+                                        nullptr);
+            auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+            heads.emplace_back(relu->getOutput());
+        }
+        auto concat = g->addOp<ConcatObj>(heads, nullptr, 1);
+        g->dataMalloc();
+
+        // dataMalloc lets intermediates reuse the memory of x, so the input
+        // is written again before every run.
+        auto plan = runtime->compile(g);
+        x->setData(IncrementalGenerator());
+        plan->run();
+        auto output = concat->getOutput();
+        vector<float> expected(output->getRawDataPtr<float *>(),
+                               output->getRawDataPtr<float *>() +
+                                   output->size());
+
+        ThreadPool pool(3);
+        for (int i = 0; i < 20; ++i)
+        {
+            // The output may share memory with x as well.
+            std::fill_n(output->getRawDataPtr<float *>(), output->size(), -1.f);
+            x->setData(IncrementalGenerator());
+            plan->run(pool);
+            EXPECT_TRUE(output->equalData(expected));
+        }
+    }
+}
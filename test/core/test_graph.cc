@@ -1,8 +1,13 @@
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
 #include "operators/matmul.h"
+#include "operators/split.h"
 #include "operators/transpose.h"
+#include "operators/unary.h"
+#include "utils/data_generator.h"
 
 #include "test.h"
 
@@ -37,4 +42,488 @@ namespace infini
         EXPECT_EQ(op->getTransA(), false);
         EXPECT_EQ(op->getTransB(), true);
     }
-}
\ No newline at end of file
+
+    TEST(Graph, OptimizeComposesTransposes)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3, 4}, DataType::Float32);
+        auto t1 = g->addOp<TransposeObj>(x, nullptr, Shape{1, 2, 0});
+        auto t2 = g->addOp<TransposeObj>(t1->getOutput(), nullptr,
+                                         Shape{1, 2, 0});
+        auto relu = g->addOp<ReluObj>(t2->getOutput(), nullptr);
+        // Composes to the identity, so the Relu reads x directly.
+        auto t3 = g->addOp<TransposeObj>(t2->getOutput(), nullptr,
+                                         Shape{1, 2, 0});
+        auto relu2 = g->addOp<ReluObj>(t3->getOutput(), nullptr);
+        g->optimize();
+        ASSERT_EQ(g->getOperators().size(), 3);
+        EXPECT_EQ(g->getTensors().size(), 4);
+        EXPECT_EQ(relu->getInputs(0), t2->getOutput());
+        EXPECT_EQ(t2->getInputs(0), x);
+        EXPECT_EQ(t2->getPermute(), (vector<int>{2, 0, 1}));
+        EXPECT_EQ(relu2->getInputs(0), x);
+        EXPECT_EQ(x->getTargets().size(), 2);
+        EXPECT_EQ(t2->getSuccessors(), OpVec{relu});
+    }
+
+    TEST(Graph, OptimizeKeepsSharedTranspose)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({5, 2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({5, 4, 3}, DataType::Float32);
+        auto t = g->addOp<TransposeObj>(b, nullptr, Shape{0, 2, 1});
+        auto matmul = g->addOp<MatmulObj>(a, t->getOutput(), nullptr);
+        auto relu = g->addOp<ReluObj>(t->getOutput(), nullptr);
+        g->optimize();
+        // The MatMul reads b transposed; the Relu still needs the Transpose.
+        EXPECT_EQ(g->getOperators().size(), 3);
+        EXPECT_EQ(matmul->getInputs(1), b);
+        EXPECT_TRUE(matmul->getTransB());
+        EXPECT_EQ(relu->getInputs(0), t->getOutput());
+        EXPECT_EQ(t->getSuccessors(), OpVec{relu});
+        EXPECT_EQ(matmul->getPredecessors().size(), 0);
+
+        g->dataMalloc();
+        a->setData(IncrementalGenerator());
+        b->setData(IncrementalGenerator());
+        runtime->run(g);
+        auto out = matmul->getOutput();
+        EXPECT_EQ(out->getDims(), (Shape{5, 2, 4}));
+        // First batch: a = [[0,1,2],[3,4,5]], b^T columns are rows of b.
+        const float *ptr = out->getRawDataPtr<float *>();
+        EXPECT_EQ(vector<float>(ptr, ptr + 8),
+                  (vector<float>{5, 14, 23, 32, 14, 50, 86, 122}));
+    }
+
+    TEST(Graph, OptimizeSinksTransposes)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3, 4}, DataType::Float32);
+        Tensor b = g->addTensor({2, 3, 4}, DataType::Float32);
+        auto ta = g->addOp<TransposeObj>(a, nullptr, Shape{0, 2, 1});
+        auto tb = g->addOp<TransposeObj>(b, nullptr, Shape{0, 2, 1});
+        auto add = g->addOp<AddObj>(ta->getOutput(), tb->getOutput(), nullptr);
+        auto back = g->addOp<TransposeObj>(add->getOutput(), nullptr,
+                                           Shape{0, 2, 1});
+        g->optimize();
+        // Both Transposes sink below the Add and cancel the last one.
+        ASSERT_EQ(g->getOperators().size(), 1);
+        EXPECT_EQ(g->getTensors().size(), 3);
+        EXPECT_EQ(g->getOperators()[0], add);
+        EXPECT_EQ(add->getInputs(), (TensorVec{a, b}));
+        EXPECT_EQ(add->getOutput(), back->getOutput());
+    }
+
+    TEST(Graph, OptimizeSinksTransposesThroughConcat)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({2, 3}, DataType::Float32);
+        auto ta = g->addOp<TransposeObj>(a, nullptr, Shape{1, 0});
+        auto tb = g->addOp<TransposeObj>(b, nullptr, Shape{1, 0});
+        auto concat = g->addOp<ConcatObj>(
+            TensorVec{ta->getOutput(), tb->getOutput()}, nullptr, 0);
+        auto relu = g->addOp<ReluObj>(concat->getOutput(), nullptr);
+        auto output = relu->getOutput();
+        g->optimize();
+        // One Transpose of the result replaces one per Concat input.
+        ASSERT_EQ(g->getOperators().size(), 3);
+        EXPECT_EQ(concat->getInputs(), (TensorVec{a, b}));
+        EXPECT_EQ(concat->getDim(), 1);
+        EXPECT_EQ(concat->getOutput()->getDims(), (Shape{2, 6}));
+        EXPECT_EQ(concat->getSuccessors()[0]->getOpType(), OpType::Transpose);
+        EXPECT_EQ(relu->getInputs(0)->getSource()->getOpType(),
+                  OpType::Transpose);
+
+        g->dataMalloc();
+        a->setData(IncrementalGenerator());
+        b->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(output->equalData(
+            vector<float>{0, 3, 1, 4, 2, 5, 0, 3, 1, 4, 2, 5}));
+    }
+
+    TEST(Graph, FoldConstants)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        Tensor w1 = g->addConstant({1, 3}, DataType::Float32);
+        Tensor w2 = g->addConstant({1, 3}, DataType::Float32);
+        std::copy_n(vector<float>{1, 0, 2}.begin(), 3,
+                    w1->getRawDataPtr<float *>());
+        std::copy_n(vector<float>{0, 1, -1}.begin(), 3,
+                    w2->getRawDataPtr<float *>());
+        auto concat = g->addOp<ConcatObj>(TensorVec{w1, w2}, nullptr, 0);
+        auto t = g->addOp<TransposeObj>(concat->getOutput(), nullptr,
+                                        Shape{1, 0});
+        auto matmul = g->addOp<MatmulObj>(x, t->getOutput(), nullptr);
+        g->optimize();
+        // Only the MatMul is left, reading the precomputed weight.
+        ASSERT_EQ(g->getOperators().size(), 1);
+        EXPECT_EQ(g->getTensors().size(), 3);
+        auto weight = matmul->getInputs(1);
+        EXPECT_TRUE(weight->isConstant());
+        EXPECT_EQ(weight->getSource(), nullptr);
+        EXPECT_TRUE(weight->equalData(vector<float>{1, 0, 0, 1, 2, -1}));
+
+        auto weightPtr = weight->getRawDataPtr<void *>();
+        g->dataMalloc();
+        EXPECT_EQ(weight->getRawDataPtr<void *>(), weightPtr);
+        x->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(matmul->getOutput()->equalData(vector<float>{4, -1, 13, -1}));
+    }
+
+    TEST(Graph, EliminateCommonSubexpressions)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto t1 = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+        auto t2 = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+        auto r1 = g->addOp<ReluObj>(t1->getOutput(), nullptr);
+        auto r2 = g->addOp<ReluObj>(t2->getOutput(), nullptr);
+        auto add = g->addOp<AddObj>(r1->getOutput(), r2->getOutput(), nullptr);
+        auto c1 = g->addOp<ClipObj>(x, nullptr, 0.f, 6.f);
+        auto c2 = g->addOp<ClipObj>(x, nullptr, 0.f, 1.f);
+        auto sub = g->addOp<SubObj>(c1->getOutput(), c2->getOutput(), nullptr);
+        // Both are graph outputs, so neither can stand in for the other.
+        auto cast1 = g->addOp<CastObj>(x, nullptr, CastType::Float2Int32);
+        auto cast2 = g->addOp<CastObj>(x, nullptr, CastType::Float2Int32);
+        g->eliminateCommonSubexpressions();
+        // The duplicated Transpose goes first, which makes the Relus equal.
+        EXPECT_EQ(g->getOperators().size(), 8);
+        EXPECT_EQ(g->getTensors().size(), 9);
+        EXPECT_EQ(add->getInputs(), (TensorVec{r1->getOutput(), r1->getOutput()}));
+        EXPECT_EQ(r1->getOutput()->getTargets().size(), 2);
+        EXPECT_EQ(r1->getSuccessors().size(), 2);
+        EXPECT_EQ(t1->getSuccessors(), OpVec{r1});
+        // Different clip bounds are kept apart.
+        EXPECT_EQ(sub->getInputs(1), c2->getOutput());
+        EXPECT_EQ(cast2->getOutput()->getSource(), cast2);
+        EXPECT_EQ(cast1->getOutput()->getSource(), cast1);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, EliminateCommonSubexpressionsKeepsGraphOutputs)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        // Both outputs are graph outputs.
+        g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+        g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+        // Only the output of the first one is a graph output.
+        auto relu1 = g->addOp<ReluObj>(x, nullptr);
+        auto relu2 = g->addOp<ReluObj>(x, nullptr);
+        g->addOp<ClipObj>(relu2->getOutput(), nullptr, 0.f, 6.f);
+        auto outputs = g->getOutputs();
+        EXPECT_EQ(outputs.size(), 4);
+        g->eliminateCommonSubexpressions();
+        EXPECT_EQ(g->getOperators().size(), 5);
+        EXPECT_EQ(g->getOutputs(), outputs);
+        EXPECT_TRUE(relu1->getOutput()->getTargets().empty());
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, SimplifyAlgebra)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        Tensor zero = g->addConstant({3}, DataType::Float32);
+        Tensor one = g->addConstant({2, 3}, DataType::Float32);
+        zero->setData(ZeroGenerator());
+        one->setData(OneGenerator());
+        auto cast = g->addOp<CastObj>(x, nullptr, CastType::Float2Float);
+        auto add = g->addOp<AddObj>(zero, cast->getOutput(), nullptr);
+        auto relu1 = g->addOp<ReluObj>(add->getOutput(), nullptr);
+        auto relu2 = g->addOp<ReluObj>(relu1->getOutput(), nullptr);
+        auto clip1 = g->addOp<ClipObj>(relu2->getOutput(), nullptr,
+                                       std::nullopt, 6.f);
+        auto clip2 = g->addOp<ClipObj>(clip1->getOutput(), nullptr, -1.f, 4.f);
+        auto div = g->addOp<DivObj>(clip2->getOutput(), one, nullptr);
+        auto concat = g->addOp<ConcatObj>(TensorVec{div->getOutput()}, nullptr, 0);
+        auto toHalf = g->addOp<CastObj>(concat->getOutput(), nullptr,
+                                        CastType::Float2Float16);
+        auto toFloat = g->addOp<CastObj>(toHalf->getOutput(), nullptr,
+                                         CastType::Float162Float);
+        auto output = toFloat->getOutput();
+
+        g->simplifyAlgebra();
+        // The lossy Cast round trip is kept, everything else folds into
+        // clip(x, 0, 4).
+        ASSERT_EQ(g->getOperators().size(), 3);
+        EXPECT_EQ(g->getTensors().size(), 4);
+        auto clip = as<ClipObj>(toHalf->getInputs(0)->getSource());
+        ASSERT_NE(clip, nullptr);
+        EXPECT_EQ(clip->getInputs(0), x);
+        EXPECT_EQ(clip->getMin(), 0.f);
+        EXPECT_EQ(clip->getMax(), 4.f);
+        EXPECT_EQ(output->getSource(), toFloat);
+
+        g->simplifyAlgebra(true);
+        ASSERT_EQ(g->getOperators().size(), 1);
+        EXPECT_EQ(output->getSource(), clip);
+        EXPECT_TRUE(g->checkValid());
+
+        g->dataMalloc();
+        std::copy_n(vector<float>{-2, 0, 1, 3, 5, 7}.begin(), 6,
+                    x->getRawDataPtr<float *>());
+        runtime->run(g);
+        EXPECT_TRUE(output->equalData(vector<float>{0, 0, 1, 3, 4, 4}));
+    }
+
+    TEST(Graph, MergeInvertedClamps)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        // Clip(5, 2) yields 2 everywhere, whatever clamp follows it.
+        for (bool matmul : {false, true})
+            for (optional<float> max : {optional<float>(), optional<float>(10.f)})
+            {
+                Graph g = make_ref<GraphObj>(runtime);
+                Tensor x = g->addTensor({2, 3}, DataType::Float32);
+                Tensor input = x;
+                if (matmul)
+                    input = g->addOp<MatmulObj>(x, g->addConstant({3, 3}), nullptr)
+                                ->getOutput();
+                auto clip = g->addOp<ClipObj>(input, nullptr, 5.f, 2.f);
+                auto output =
+                    max ? g->addOp<ClipObj>(clip->getOutput(), nullptr,
+                                            std::nullopt, max)
+                              ->getOutput()
+                        : g->addOp<ReluObj>(clip->getOutput(), nullptr)
+                              ->getOutput();
+                if (matmul)
+                    g->fuseMatmulEpilogue();
+                else
+                    g->simplifyAlgebra();
+                EXPECT_EQ(g->getOperators().size(), 1);
+                g->dataMalloc();
+                std::copy_n(vector<float>{-2, 0, 1, 3, 5, 7}.begin(), 6,
+                            x->getRawDataPtr<float *>());
+                runtime->run(g);
+                EXPECT_TRUE(output->equalData(vector<float>(6, 2.f)));
+            }
+    }
+
+    TEST(Graph, SimplifyAlgebraKeepsIntegerRoundTrips)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto toInt8 = g->addOp<CastObj>(x, nullptr, CastType::Float2Int8);
+        auto toFloat = g->addOp<CastObj>(toInt8->getOutput(), nullptr,
+                                         CastType::Int82Float);
+        // Int8 saturates and truncates, which is more than a precision loss.
+        g->simplifyAlgebra(true);
+        EXPECT_EQ(g->getOperators(), (OpVec{toInt8, toFloat}));
+        EXPECT_EQ(toFloat->getInputs(0), toInt8->getOutput());
+    }
+
+    TEST(Graph, ReorderMatmulChains)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({8, 1}, DataType::Float32);
+        Tensor b = g->addTensor({1, 8}, DataType::Float32);
+        Tensor c = g->addTensor({1, 8}, DataType::Float32);
+        auto ab = g->addOp<MatmulObj>(a, b, nullptr);
+        auto abc = g->addOp<MatmulObj>(ab->getOutput(), c, nullptr, false, true);
+        auto output = abc->getOutput();
+        g->reorderMatmulChains();
+
+        // (a * b) * c^T costs 128 multiply-adds, a * (b * c^T) only 16.
+        ASSERT_EQ(g->getOperators().size(), 2);
+        EXPECT_EQ(g->getTensors().size(), 5);
+        auto root = as<MatmulObj>(output->getSource());
+        ASSERT_NE(root, nullptr);
+        EXPECT_EQ(root->getInputs(0), a);
+        auto bc = as<MatmulObj>(root->getInputs(1)->getSource());
+        ASSERT_NE(bc, nullptr);
+        EXPECT_EQ(bc->getInputs(), (TensorVec{b, c}));
+        EXPECT_FALSE(bc->getTransA());
+        EXPECT_TRUE(bc->getTransB());
+        EXPECT_TRUE(g->checkValid());
+
+        g->dataMalloc();
+        a->setData(IncrementalGenerator());
+        b->setData(OneGenerator());
+        c->setData(OneGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(output->equalData(vector<float>{0, 8, 16, 24, 32, 40, 48, 56}));
+    }
+
+    TEST(Graph, FuseHorizontalMatmuls)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        Tensor wq = g->addConstant({3, 2}, DataType::Float32);
+        Tensor wk = g->addConstant({3, 1}, DataType::Float32);
+        Tensor wv = g->addConstant({2, 3}, DataType::Float32);
+        Tensor y = g->addTensor({3, 2}, DataType::Float32);
+        wq->setData(IncrementalGenerator());
+        wk->setData(OneGenerator());
+        wv->setData(IncrementalGenerator());
+        auto q = g->addOp<MatmulObj>(x, wq, nullptr);
+        auto k = g->addOp<MatmulObj>(x, wk, nullptr);
+        // A different layout of B and a non-constant B are left alone.
+        auto v = g->addOp<MatmulObj>(x, wv, nullptr, false, true);
+        auto other = g->addOp<MatmulObj>(x, y, nullptr);
+        g->fuseHorizontalMatmuls();
+
+        ASSERT_EQ(g->getOperators().size(), 4);
+        auto split = as<SplitObj>(q->getOutput()->getSource());
+        ASSERT_NE(split, nullptr);
+        EXPECT_EQ(split->getOutputs(), (TensorVec{q->getOutput(), k->getOutput()}));
+        EXPECT_EQ(split->getSizes(), (vector<int>{2, 1}));
+        auto fused = as<MatmulObj>(split->getInputs(0)->getSource());
+        ASSERT_NE(fused, nullptr);
+        EXPECT_EQ(fused->getInputs(0), x);
+        EXPECT_TRUE(fused->getInputs(1)->isConstant());
+        EXPECT_EQ(fused->getInputs(1)->getDims(), (Shape{3, 3}));
+        EXPECT_EQ(v->getOutput()->getSource(), v);
+        EXPECT_EQ(other->getOutput()->getSource(), other);
+        EXPECT_TRUE(g->checkValid());
+
+        g->dataMalloc();
+        x->setData(IncrementalGenerator());
+        y->setData(OneGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(q->getOutput()->equalData(vector<float>{10, 13, 28, 40}));
+        EXPECT_TRUE(k->getOutput()->equalData(vector<float>{3, 12}));
+    }
+
+    TEST(Graph, MinMemorySchedule)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        // Four branches that each widen x and reduce it again, added layer
+        // by layer: in insertion order all wide tensors are live at once.
+        auto build = [&]()
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor x = g->addTensor({16, 16}, DataType::Float32);
+            TensorVec wide, heads;
+            for (int i = 0; i < 4; ++i)
+                wide.emplace_back(
+                    g->addOp<MatmulObj>(x, g->addConstant({16, 64}), nullptr)
+                        ->getOutput());
+            for (int i = 0; i < 4; ++i)
+                heads.emplace_back(
+                    g->addOp<MatmulObj>(wide[i], g->addConstant({64, 1}), nullptr)
+                        ->getOutput());
+            g->addOp<ConcatObj>(heads, nullptr, 1);
+            return g;
+        };
+        auto peak = [](const Graph &g)
+        {
+            size_t ret = SIZE_MAX;
+            for (auto &plan : g->planMemory())
+                ret = std::min(ret, plan.peak);
+            return ret;
+        };
+        const size_t wideBytes = 16 * 64 * sizeof(float);
+
+        Graph g = build();
+        EXPECT_GE(peak(g), 4 * wideBytes);
+
+        for (size_t exactLimit : {16, 0})
+        {
+            g = build();
+            g->setSchedule(GraphObj::Schedule::MinMemory, exactLimit);
+            ASSERT_TRUE(g->topo_sort());
+            // Every branch is finished before the next one starts.
+            const auto &ops = g->getOperators();
+            for (size_t i = 0; i < 4; ++i)
+                EXPECT_EQ(ops[2 * i + 1]->getInputs(0), ops[2 * i]->getOutput());
+            EXPECT_LT(peak(g), 2 * wideBytes);
+        }
+        // The exact search keeps a table of 2^n entries.
+        EXPECT_THROW(g->setSchedule(GraphObj::Schedule::MinMemory, 31),
+                     Exception);
+    }
+
+    TEST(Graph, IncrementalTopoSort)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto relu1 = g->addOp<ReluObj>(x, nullptr);
+        auto relu2 = g->addOp<ReluObj>(relu1->getOutput(), nullptr);
+        ASSERT_TRUE(g->topo_sort());
+        // Appending an operator keeps the order: a fresh sort would have
+        // placed relu3 ahead of relu2.
+        auto relu3 = g->addOp<ReluObj>(x, nullptr);
+        ASSERT_TRUE(g->topo_sort());
+        EXPECT_EQ(g->getOperators(), (OpVec{relu1, relu2, relu3}));
+
+        // Producing a tensor that is already read reorders the graph.
+        Tensor t = g->addTensor({2, 3}, DataType::Float32);
+        auto relu4 = g->addOp<ReluObj>(t, nullptr);
+        ASSERT_TRUE(g->topo_sort());
+        auto producer = g->addOpWithOutputs<ReluObj>(x, t);
+        ASSERT_TRUE(g->topo_sort());
+        const auto &ops = g->getOperators();
+        EXPECT_LT(std::find(ops.begin(), ops.end(), producer),
+                  std::find(ops.begin(), ops.end(), relu4));
+    }
+
+    TEST(Graph, IndexedStorage)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        auto relu1 = g->addOp<ReluObj>(x, nullptr);
+        auto relu2 = g->addOp<ReluObj>(x, nullptr);
+        auto relu3 = g->addOp<ReluObj>(x, nullptr);
+        EXPECT_EQ(g->getTensor(relu2->getOutput()->getFuid()),
+                  relu2->getOutput());
+        EXPECT_TRUE(g->checkValid());
+
+        // Removals keep the remaining operators and tensors in order.
+        auto y = relu2->getOutput();
+        g->removeOperator(relu2);
+        g->removeTensor(y);
+        g->deleteConnection(x, relu2);
+        EXPECT_EQ(g->getOperators(), (OpVec{relu1, relu3}));
+        EXPECT_EQ(g->getTensors(),
+                  (TensorVec{x, relu1->getOutput(), relu3->getOutput()}));
+        EXPECT_EQ(g->getTensor(y->getFuid()), nullptr);
+        EXPECT_EQ(x->getTargets(), (OpVec{relu1, relu3}));
+        EXPECT_TRUE(g->checkValid());
+
+        // Operators added after a removal still come last.
+        g->removeOperator(relu1);
+        auto relu4 = g->addOp<ReluObj>(x, nullptr);
+        EXPECT_EQ(g->getOperators(), (OpVec{relu3, relu4}));
+    }
+
+    TEST(Graph, OptimizeFusesElementWise)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({3}, DataType::Float32);
+        auto add = g->addOp<AddObj>(a, b, nullptr);
+        auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+        auto clip = g->addOp<ClipObj>(relu->getOutput(), nullptr, 0.f, 6.f);
+        auto mul = g->addOp<MulObj>(clip->getOutput(), b, nullptr);
+        // A second reader keeps the Relu output materialized.
+        auto sub = g->addOp<SubObj>(relu->getOutput(), a, nullptr);
+        g->optimize();
+        // Add+Relu and Clip+Mul fuse; the lone Sub is left alone.
+        EXPECT_EQ(g->getOperators().size(), 3);
+        EXPECT_EQ(g->getTensors().size(), 5);
+        EXPECT_EQ(relu->getOutput()->getSource()->getOpType(),
+                  OpType::FusedElementWise);
+        EXPECT_EQ(sub->getOutput()->getSource(), sub);
+        EXPECT_EQ(mul->getOutput()->getSource()->getOpType(),
+                  OpType::FusedElementWise);
+    }
+}
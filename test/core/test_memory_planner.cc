@@ -0,0 +1,107 @@
+#include "core/graph.h"
+#include "core/memory_planner.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <array>
+#include <numeric>
+
+namespace infini
+{
+    // Whether two blocks that live at the same time share bytes.
+    bool overlaps(const vector<std::array<size_t, 3>> &blocks,
+                  const vector<size_t> &offsets)
+    {
+        for (size_t i = 0; i < blocks.size(); ++i)
+            for (size_t j = i + 1; j < blocks.size(); ++j)
+                if (blocks[i][1] <= blocks[j][2] &&
+                    blocks[j][1] <= blocks[i][2] &&
+                    offsets[i] < offsets[j] + blocks[j][0] &&
+                    offsets[j] < offsets[i] + blocks[i][0])
+                    return true;
+        return false;
+    }
+
+    TEST(MemoryPlanner, Strategies)
+    {
+        // {bytes, first step, last step}
+        vector<std::array<size_t, 3>> blocks{
+            {32, 0, 1}, {64, 1, 2}, {16, 2, 4}, {64, 3, 4}, {40, 0, 0}, {8, 4, 5}};
+        MemoryPlanner planner;
+        for (auto &[bytes, first, last] : blocks)
+            planner.addBlock(bytes, first, last);
+        ASSERT_EQ(planner.size(), blocks.size());
+
+        for (auto strategy : MemoryPlanner::strategies)
+        {
+            auto plan = planner.plan(strategy);
+            EXPECT_EQ(plan.strategy, strategy);
+            ASSERT_EQ(plan.offsets.size(), blocks.size());
+            EXPECT_FALSE(overlaps(blocks, plan.offsets))
+                << MemoryPlanner::toString(strategy);
+            // No step holds more than 96 live bytes.
+            EXPECT_GE(plan.peak, 96u);
+            for (auto offset : plan.offsets)
+                EXPECT_EQ(offset % sizeof(uint64_t), 0u);
+        }
+        auto plan = planner.plan(MemoryPlanner::Strategy::GreedyBySize);
+        EXPECT_EQ(plan.peak, 96u);
+        EXPECT_LE(planner.planBest().peak, plan.peak);
+    }
+
+    TEST(MemoryPlanner, DataMalloc)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({64}, DataType::Float32);
+        Tensor y = x;
+        for (int i = 0; i < 4; ++i)
+            y = g->addOp<ReluObj>(y, nullptr)->getOutput();
+        auto plans = g->planMemory();
+        ASSERT_EQ(plans.size(), std::size(MemoryPlanner::strategies));
+        // Every Relu runs in place, so the chain needs a single tensor.
+        for (auto &plan : plans)
+            EXPECT_EQ(plan.peak, x->getBytes());
+
+        g->dataMalloc(MemoryPlanner::Strategy::IntervalColoring);
+        EXPECT_EQ(y->getRawDataPtr<void *>(), x->getRawDataPtr<void *>());
+        x->setData(IncrementalGenerator());
+        runtime->run(g);
+        vector<float> expected(64);
+        std::iota(expected.begin(), expected.end(), 0.f);
+        EXPECT_TRUE(y->equalData(expected));
+    }
+
+    TEST(MemoryPlanner, InPlace)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({4, 8}, DataType::Float32);
+        Tensor bias = g->addTensor({8}, DataType::Float32);
+        auto relu = g->addOp<ReluObj>(x, nullptr);
+        // x is still read by the Add, so the Relu cannot overwrite it.
+        auto add = g->addOp<AddObj>(bias, relu->getOutput(), nullptr);
+        auto sub = g->addOp<SubObj>(add->getOutput(), x, nullptr);
+        // A Cast between types of the same width can run in place too.
+        auto cast = g->addOp<CastObj>(sub->getOutput(), nullptr,
+                                      CastType::Float2Int32);
+        g->dataMalloc();
+
+        auto ptr = [](const Tensor &t)
+        { return t->getRawDataPtr<void *>(); };
+        EXPECT_NE(ptr(relu->getOutput()), ptr(x));
+        // The broadcast bias is never overwritten, the Relu output is.
+        EXPECT_EQ(ptr(add->getOutput()), ptr(relu->getOutput()));
+        EXPECT_EQ(ptr(sub->getOutput()), ptr(add->getOutput()));
+        EXPECT_EQ(ptr(cast->getOutput()), ptr(sub->getOutput()));
+        EXPECT_TRUE(g->getMemoryDependencies(add).empty());
+
+        x->setData(IncrementalGenerator());
+        bias->setData(OneGenerator());
+        runtime->run(g);
+        vector<int32_t> expected(32, 1);
+        EXPECT_TRUE(cast->getOutput()->equalData(expected));
+    }
+}
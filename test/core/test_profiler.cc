@@ -0,0 +1,51 @@
+#include "core/graph.h"
+#include "core/profiler.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    TEST(Profiler, RecordsEveryKernel)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({3}, DataType::Float32);
+        auto add = g->addOp<AddObj>(a, b, nullptr);
+        g->addOp<ReluObj>(add->getOutput(), nullptr);
+        g->dataMalloc();
+
+        runtime->setProfiling(true);
+        runtime->run(g);
+        runtime->run(g);
+        auto profiler = runtime->getProfiler();
+        runtime->setProfiling(false);
+
+        auto records = profiler->getRecords();
+        ASSERT_EQ(records.size(), 4);
+        EXPECT_EQ(records[0].opType, "Add");
+        EXPECT_EQ(records[0].shapes, "[2,3];[3] -> [2,3]");
+        EXPECT_EQ(records[0].dtype, "Float32");
+        EXPECT_EQ(records[1].opType, "Relu");
+        EXPECT_EQ(records[1].kernelName, "reluNaive_CPU");
+        EXPECT_LE(records[1].start, records[2].start);
+
+        std::ostringstream summary;
+        profiler->printSummary(summary);
+        EXPECT_NE(summary.str().find("Relu"), string::npos);
+
+        std::ostringstream trace;
+        profiler->exportChromeTrace(trace);
+        EXPECT_EQ(trace.str().rfind("{\"traceEvents\":[", 0), 0);
+        EXPECT_NE(trace.str().find("\"name\":\"reluNaive_CPU\""),
+                  string::npos);
+
+        // Nothing is recorded once profiling is off.
+        runtime->run(g);
+        EXPECT_EQ(profiler->getRecords().size(), 4);
+        EXPECT_EQ(runtime->getProfiler(), nullptr);
+    }
+}
@@ -0,0 +1,67 @@
+#include "core/graph.h"
+#include "core/rewriter.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    TEST(Rewriter, RunsToFixpoint)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        Tensor y = x;
+        for (int i = 0; i < 4; ++i)
+            y = g->addOp<ReluObj>(y, nullptr)->getOutput();
+        auto sub = g->addOp<SubObj>(y, x, nullptr);
+
+        // relu(relu(x)) == relu(x)
+        RewriteRule rule{
+            "DropReluOfRelu",
+            Pattern::op(OpType::Relu, {Pattern::op(OpType::Relu)}),
+            [](const OpVec &matched, GraphRewriter &rewriter)
+            {
+                rewriter.replaceAllUses(matched[0]->getOutput(),
+                                        matched[1]->getOutput());
+                return rewriter.eraseIfUnread(matched[0]);
+            }};
+        EXPECT_TRUE(GraphRewriter(*g).apply({rule}));
+        ASSERT_EQ(g->getOperators().size(), 2);
+        EXPECT_EQ(g->getTensors().size(), 3);
+        auto relu = sub->getInputs(0)->getSource();
+        EXPECT_EQ(relu->getInputs(0), x);
+        EXPECT_EQ(relu->getSuccessors(), OpVec{sub});
+        EXPECT_EQ(sub->getPredecessors(), OpVec{relu});
+        EXPECT_TRUE(g->checkValid());
+        EXPECT_FALSE(GraphRewriter(*g).apply({rule}));
+    }
+
+    TEST(Rewriter, MatchesCommutativeSingleUse)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({3, 4}, DataType::Float32);
+        Tensor bias = g->addTensor({4}, DataType::Float32);
+        auto matmul = g->addOp<MatmulObj>(a, b, nullptr);
+        auto add = g->addOp<AddObj>(bias, matmul->getOutput(), nullptr);
+
+        auto pattern = Pattern::op(OpType::Add,
+                                   {Pattern::op(OpType::MatMul).singleUse(),
+                                    Pattern::any()})
+                           .commutative();
+        OpVec matched;
+        ASSERT_TRUE(pattern.match(add, matched));
+        EXPECT_EQ(matched, (OpVec{add, matmul}));
+
+        // A second reader of the MatMul output breaks single use.
+        g->addOp<ReluObj>(matmul->getOutput(), nullptr);
+        matched.clear();
+        EXPECT_FALSE(pattern.match(add, matched));
+        EXPECT_TRUE(matched.empty());
+    }
+}
@@ -0,0 +1,73 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+template <typename Src, typename Dst>
+vector<Dst> runCastNativeCpu(const vector<Src> &data, DataType srcType,
+                             CastType castType) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({(int)data.size()}, srcType);
+    auto op = g->addOp<CastObj>(input, nullptr, castType);
+    g->dataMalloc();
+    std::copy(data.begin(), data.end(), input->getRawDataPtr<Src *>());
+    runtime->run(g);
+    auto outPtr = op->getOutput()->getRawDataPtr<Dst *>();
+    return vector<Dst>(outPtr, outPtr + data.size());
+}
+
+TEST(Cast, NativeCpuFloat16) {
+    float inf = std::numeric_limits<float>::infinity();
+    auto half = runCastNativeCpu<float, uint16_t>(
+        {0.f, -0.f, 1.f, -2.f, 0.1f, 65504.f, 65520.f, 1e-7f, 1e-10f, inf,
+         std::nanf("")},
+        DataType::Float32, CastType::Float2Float16);
+    EXPECT_EQ(half, (vector<uint16_t>{0x0000, 0x8000, 0x3c00, 0xc000, 0x2e66,
+                                      0x7bff, 0x7c00, 0x0002, 0x0000, 0x7c00,
+                                      0x7e00}));
+
+    auto back = runCastNativeCpu<uint16_t, float>(
+        {0x0000, 0x3c00, 0xc000, 0x7bff, 0x0001, 0x7c00},
+        DataType::Float16, CastType::Float162Float);
+    EXPECT_EQ(back, (vector<float>{0.f, 1.f, -2.f, 65504.f, 5.9604645e-8f, inf}));
+}
+
+TEST(Cast, NativeCpuBFloat16) {
+    auto bf16 = runCastNativeCpu<float, uint16_t>(
+        {1.f, -2.f, 1.00390625f, 1.01171875f, std::nanf("")},
+        DataType::Float32, CastType::Float2BFloat16);
+    // 1 + 2^-8 is a tie and rounds to even, 1 + 3 * 2^-8 rounds up.
+    EXPECT_EQ(bf16,
+              (vector<uint16_t>{0x3f80, 0xc000, 0x3f80, 0x3f82, 0x7fc0}));
+
+    auto back = runCastNativeCpu<uint16_t, float>(
+        {0x3f80, 0xc000, 0x3f82}, DataType::BFloat16, CastType::BFloat162Float);
+    EXPECT_EQ(back, (vector<float>{1.f, -2.f, 1.015625f}));
+}
+
+TEST(Cast, NativeCpuSaturatingIntegers) {
+    auto i8 = runCastNativeCpu<float, int8_t>(
+        {-1000.f, -3.7f, 0.f, 3.7f, 1000.f, std::nanf("")}, DataType::Float32,
+        CastType::Float2Int8);
+    EXPECT_EQ(i8, (vector<int8_t>{-128, -3, 0, 3, 127, 0}));
+
+    auto u32 = runCastNativeCpu<int64_t, uint32_t>(
+        {-1, 0, 4294967295ll, 4294967296ll}, DataType::Int64,
+        CastType::Int642Uint32);
+    EXPECT_EQ(u32, (vector<uint32_t>{0, 0, 4294967295u, 4294967295u}));
+
+    auto i16 = runCastNativeCpu<int32_t, int16_t>(
+        {-40000, -5, 5, 40000}, DataType::Int32, CastType::Int322Int16);
+    EXPECT_EQ(i16, (vector<int16_t>{-32768, -5, 5, 32767}));
+
+    auto f32 = runCastNativeCpu<uint8_t, float>({0, 7, 255}, DataType::UInt8,
+                                                CastType::Uint82Float);
+    EXPECT_EQ(f32, (vector<float>{0.f, 7.f, 255.f}));
+}
+
+} // namespace infini
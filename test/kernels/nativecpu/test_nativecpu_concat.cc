@@ -25,4 +25,38 @@ TEST(Concat, NativeCpu) {
                       6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
 }
 
+TEST(Concat, NativeCpuAxes) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto t1 = g->addTensor({1, 2}, DataType::UInt32);
+        auto t2 = g->addTensor({2, 2}, DataType::UInt32);
+        auto op = g->addOp<ConcatObj>(TensorVec{t1, t2}, nullptr, 0);
+        g->dataMalloc();
+        t1->setData(IncrementalGenerator());
+        t2->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(
+            op->getOutput()->equalData(vector<uint32_t>{0, 1, 0, 1, 2, 3}));
+    }
+    {
+        // Large enough to take the streaming-store path.
+        Graph g = make_ref<GraphObj>(runtime);
+        auto t1 = g->addTensor({2, 300001}, DataType::Float32);
+        auto t2 = g->addTensor({2, 3}, DataType::Float32);
+        auto op = g->addOp<ConcatObj>(TensorVec{t1, t2}, nullptr, -1);
+        g->dataMalloc();
+        t1->setData(IncrementalGenerator());
+        t2->setData(OneGenerator());
+        runtime->run(g);
+        vector<float> ans;
+        for (int row = 0; row < 2; ++row) {
+            for (int i = 0; i < 300001; ++i)
+                ans.emplace_back(row * 300001 + i);
+            ans.insert(ans.end(), 3, 1);
+        }
+        EXPECT_TRUE(op->getOutput()->equalData(ans));
+    }
+}
+
 } // namespace infini
@@ -41,4 +41,27 @@ TEST(ElementWise, NativeCpu) {
         Shape{2, 1, 1}, ExpectOutput{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
 }
 
+TEST(ElementWise, NativeCpuBroadcastPatterns) {
+    // same shape
+    testElementWiseNativeCpu<AddObj>(
+        IncrementalGenerator(), IncrementalGenerator(), Shape{2, 3},
+        Shape{2, 3}, ExpectOutput{0, 2, 4, 6, 8, 10});
+    // scalar
+    testElementWiseNativeCpu<SubObj>(IncrementalGenerator(), OneGenerator(),
+                                     Shape{2, 3}, Shape{},
+                                     ExpectOutput{-1, 0, 1, 2, 3, 4});
+    // row broadcast
+    testElementWiseNativeCpu<MulObj>(
+        IncrementalGenerator(), IncrementalGenerator(), Shape{2, 3}, Shape{3},
+        ExpectOutput{0, 1, 4, 0, 4, 10});
+    // column broadcast
+    testElementWiseNativeCpu<AddObj>(
+        IncrementalGenerator(), IncrementalGenerator(), Shape{2, 1}, Shape{2, 3},
+        ExpectOutput{0, 1, 2, 4, 5, 6});
+    // both operands broadcast along different axes
+    testElementWiseNativeCpu<SubObj>(
+        IncrementalGenerator(), IncrementalGenerator(), Shape{3, 1}, Shape{1, 2},
+        ExpectOutput{0, -1, 1, 0, 2, 1});
+}
+
 } // namespace infini
@@ -0,0 +1,76 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// clip(relu(t) + t / d, -100, 5000) with t = (a - c) * b. t has two readers,
+// so it stays materialized and the graph fuses into two operators.
+Tensor buildBranchyExpression(const Graph &g, TensorVec &inputs) {
+    auto a = g->addTensor({3, 5, 300}, DataType::Float32);
+    auto b = g->addTensor({300}, DataType::Float32);
+    auto c = g->addTensor({5, 1}, DataType::Float32);
+    auto d = g->addTensor({1}, DataType::Float32);
+    inputs = {a, b, c, d};
+    auto t = g->addOp<MulObj>(g->addOp<SubObj>(a, c, nullptr)->getOutput(), b,
+                              nullptr)
+                 ->getOutput();
+    auto relu = g->addOp<ReluObj>(t, nullptr)->getOutput();
+    auto div = g->addOp<DivObj>(t, d, nullptr)->getOutput();
+    auto add = g->addOp<AddObj>(relu, div, nullptr)->getOutput();
+    return g->addOp<ClipObj>(add, nullptr, -100.f, 5000.f)->getOutput();
+}
+
+TEST(FusedElementWise, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto run = [&](bool fuse) {
+        Graph g = make_ref<GraphObj>(runtime);
+        TensorVec inputs;
+        auto output = buildBranchyExpression(g, inputs);
+        if (fuse) {
+            g->fuseElementWise();
+            EXPECT_EQ(g->getOperators().size(), 2);
+            for (auto &op : g->getOperators())
+                EXPECT_EQ(op->getOpType(), OpType::FusedElementWise);
+        }
+        g->dataMalloc();
+        inputs[0]->setData(IncrementalGenerator());
+        inputs[1]->setData(IncrementalGenerator());
+        inputs[2]->setData(ValGenerator<100>());
+        inputs[3]->setData(ValGenerator<2>());
+        runtime->run(g);
+        return std::make_pair(g, output);
+    };
+    auto [g0, reference] = run(false);
+    auto [g1, fused] = run(true);
+    EXPECT_TRUE(fused->equalData(reference));
+}
+
+TEST(FusedElementWise, NativeCpuChain) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3}, DataType::UInt32);
+    auto b = g->addTensor({3}, DataType::UInt32);
+    auto c = g->addTensor({2, 1}, DataType::UInt32);
+    auto add = g->addOp<AddObj>(a, b, nullptr);
+    auto mul = g->addOp<MulObj>(add->getOutput(), c, nullptr);
+    auto clip =
+        g->addOp<ClipObj>(mul->getOutput(), nullptr, std::nullopt, 6.f);
+    auto output = clip->getOutput();
+    g->fuseElementWise();
+    ASSERT_EQ(g->getOperators().size(), 1);
+    EXPECT_EQ(g->getTensors().size(), 4);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+    c->setData(IncrementalGenerator());
+    runtime->run(g);
+    // (a + b) * c = {0, 0, 0, 3, 5, 7}, clipped at 6 from above.
+    EXPECT_TRUE(output->equalData(vector<uint32_t>{0, 0, 0, 3, 5, 6}));
+}
+
+} // namespace infini
@@ -0,0 +1,132 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Reference matmul on row-major data with the same broadcast and transpose
+// semantics as MatmulObj.
+template <typename T>
+vector<T> naiveMatmul(const vector<T> &a, const vector<T> &b, size_t batchA,
+                      size_t batchB, size_t m, size_t n, size_t k, bool transA,
+                      bool transB) {
+    size_t batch = std::max(batchA, batchB);
+    vector<T> c(batch * m * n, 0);
+    for (size_t bt = 0; bt < batch; ++bt) {
+        const T *pa = a.data() + (batchA == 1 ? 0 : bt) * m * k;
+        const T *pb = b.data() + (batchB == 1 ? 0 : bt) * k * n;
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j) {
+                T sum = 0;
+                for (size_t p = 0; p < k; ++p)
+                    sum += (transA ? pa[p * m + i] : pa[i * k + p]) *
+                           (transB ? pb[j * k + p] : pb[p * n + j]);
+                c[bt * m * n + i * n + j] = sum;
+            }
+    }
+    return c;
+}
+
+void testMatmulNativeCpu(size_t batchA, size_t batchB, size_t m, size_t n,
+                         size_t k, bool transA, bool transB) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Shape shapeA = transA ? Shape{(int)batchA, (int)k, (int)m}
+                          : Shape{(int)batchA, (int)m, (int)k};
+    Shape shapeB = transB ? Shape{(int)batchB, (int)n, (int)k}
+                          : Shape{(int)batchB, (int)k, (int)n};
+    auto a = g->addTensor(shapeA, DataType::UInt32);
+    auto b = g->addTensor(shapeB, DataType::UInt32);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr, transA, transB);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+    runtime->run(g);
+
+    vector<uint32_t> va(a->size()), vb(b->size());
+    for (size_t i = 0; i < va.size(); ++i)
+        va[i] = i;
+    for (size_t i = 0; i < vb.size(); ++i)
+        vb[i] = i;
+    EXPECT_TRUE(op->getOutput()->equalData(
+        naiveMatmul(va, vb, batchA, batchB, m, n, k, transA, transB)));
+}
+
+TEST(Matmul, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({1, 2, 3}, DataType::Float32);
+    auto b = g->addTensor({1, 3, 2}, DataType::Float32);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<float>{10, 13, 28, 40}));
+}
+
+TEST(Matmul, NativeCpuTransposeAndBroadcast) {
+    testMatmulNativeCpu(1, 1, 5, 7, 3, false, false);
+    testMatmulNativeCpu(2, 2, 5, 7, 3, true, false);
+    testMatmulNativeCpu(3, 1, 5, 7, 3, false, true);
+    testMatmulNativeCpu(1, 3, 5, 7, 3, true, true);
+}
+
+TEST(Matmul, NativeCpuMultiBlock) {
+    // Crosses the M, N and K cache-block boundaries and leaves partial
+    // register tiles on every edge.
+    testMatmulNativeCpu(2, 1, 101, 523, 300, false, false);
+    testMatmulNativeCpu(1, 2, 97, 515, 259, true, true);
+}
+
+// MatMul -> Add(bias) -> Relu -> Clip, run once as separate operators and
+// once with everything folded into the MatMul epilogue.
+void testMatmulEpilogueNativeCpu(size_t m, size_t n, size_t k,
+                                 const Shape &biasShape) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto run = [&](bool fuse) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor({(int)m, (int)k}, DataType::Float32);
+        auto b = g->addTensor({(int)k, (int)n}, DataType::Float32);
+        auto bias = g->addTensor(biasShape, DataType::Float32);
+        auto mm = g->addOp<MatmulObj>(a, b, nullptr);
+        // The bias is the first Add input to check both operand orders.
+        auto add = g->addOp<AddObj>(bias, mm->getOutput(), nullptr);
+        auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+        auto clip = g->addOp<ClipObj>(relu->getOutput(), nullptr, std::nullopt,
+                                      float(k * k * k));
+        auto output = clip->getOutput();
+        if (fuse) {
+            g->fuseMatmulEpilogue();
+            EXPECT_EQ(g->getOperators().size(), 1);
+            EXPECT_EQ(mm->getBias(), bias);
+            EXPECT_EQ(mm->getOutput(), output);
+        }
+        g->dataMalloc();
+        a->setData(IncrementalGenerator());
+        b->setData(IncrementalGenerator());
+        float *biasPtr = bias->getRawDataPtr<float *>();
+        for (size_t i = 0; i < bias->size(); ++i)
+            biasPtr[i] = (i % 2 ? 1.f : -1.f) * float(k * k * i);
+        runtime->run(g);
+        return std::make_pair(g, output);
+    };
+    auto [g0, reference] = run(false);
+    auto [g1, fused] = run(true);
+    EXPECT_TRUE(fused->equalData(reference));
+}
+
+TEST(Matmul, NativeCpuEpilogue) {
+    testMatmulEpilogueNativeCpu(5, 7, 3, {7});
+    testMatmulEpilogueNativeCpu(5, 7, 3, {1, 1});
+    // Crosses the N and K cache blocks, so the epilogue must only run on
+    // the last K pass and track the column of every block.
+    testMatmulEpilogueNativeCpu(13, 523, 300, {1, 523});
+}
+
+} // namespace infini
@@ -0,0 +1,42 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/split.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Split, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+
+    auto t = g->addTensor({2, 2, 4}, DataType::Float32);
+    auto op =
+        g->addOp<SplitObj>(t, std::nullopt, 2, vector<int>{1, 0, 3});
+    g->dataMalloc();
+    t->setData(IncrementalGenerator());
+
+    runtime->run(g);
+    auto outputs = op->getOutputs();
+    EXPECT_TRUE(outputs[0]->equalData(vector<float>{0, 4, 8, 12}));
+    EXPECT_EQ(outputs[1]->size(), 0);
+    EXPECT_TRUE(outputs[2]->equalData(
+        vector<float>{1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15}));
+}
+
+TEST(Split, NativeCpuAxis0) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+
+    auto t = g->addTensor({3, 2}, DataType::UInt32);
+    auto op = g->addOp<SplitObj>(t, std::nullopt, 0, vector<int>{1, 2});
+    g->dataMalloc();
+    t->setData(IncrementalGenerator());
+
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutputs()[0]->equalData(vector<uint32_t>{0, 1}));
+    EXPECT_TRUE(
+        op->getOutputs()[1]->equalData(vector<uint32_t>{2, 3, 4, 5}));
+}
+
+} // namespace infini
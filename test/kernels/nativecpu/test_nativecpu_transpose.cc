@@ -24,4 +24,51 @@ TEST(Transpose, NativeCpu) {
                                                           8, 9, 10, 11, 20, 21, 22, 23}));
 }
 
+void testTransposeNativeCpu(const Shape &shape, const Shape &permute,
+                            DataType dtype) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, dtype);
+    auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    runtime->run(g);
+
+    // Reference: walk the output in order and gather from the input.
+    auto outDim = op->getOutput()->getDims();
+    int rank = shape.size();
+    vector<size_t> inStride(rank, 1);
+    for (int i = rank - 2; i >= 0; --i)
+        inStride[i] = inStride[i + 1] * shape[i + 1];
+    vector<uint32_t> ans(input->size());
+    for (size_t o = 0; o < ans.size(); ++o) {
+        size_t rest = o, inIdx = 0;
+        for (int j = rank - 1; j >= 0; --j) {
+            inIdx += rest % outDim[j] * inStride[permute[j]];
+            rest /= outDim[j];
+        }
+        ans[o] = inIdx;
+    }
+    if (dtype == DataType::Float32)
+        EXPECT_TRUE(op->getOutput()->equalData(
+            vector<float>(ans.begin(), ans.end())));
+    else
+        EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+TEST(Transpose, NativeCpuPermutations) {
+    testTransposeNativeCpu({2, 67, 3, 130}, {0, 2, 1, 3}, DataType::Float32);
+    testTransposeNativeCpu({2, 67, 3, 130}, {0, 1, 3, 2}, DataType::UInt32);
+    testTransposeNativeCpu({3, 70, 1, 90}, {3, 2, 0, 1}, DataType::Float32);
+    testTransposeNativeCpu({4, 5, 6, 7}, {2, 3, 0, 1}, DataType::UInt32);
+    testTransposeNativeCpu({2, 3, 4, 5, 6}, {4, 0, 3, 1, 2}, DataType::Float32);
+    testTransposeNativeCpu({1, 1, 8, 1}, {3, 2, 1, 0}, DataType::Float32);
+}
+
+TEST(Transpose, NativeCpuZeroExtent) {
+    testTransposeNativeCpu({3, 0}, {1, 0}, DataType::Float32);
+    testTransposeNativeCpu({2, 0, 4}, {2, 1, 0}, DataType::UInt32);
+    testTransposeNativeCpu({0, 5, 6}, {0, 2, 1}, DataType::Float32);
+}
+
 } // namespace infini
@@ -0,0 +1,47 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+const vector<float> unaryInput{-3, -1.5, 0, 0.5, 2, 4};
+
+template <class T, class... Args>
+void testUnaryNativeCpu(const vector<float> &ansVec, bool inplace,
+                        Args &&...args) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({2, 3}, DataType::Float32);
+    auto op = g->addOp<T>(input, nullptr, std::forward<Args>(args)...);
+    g->dataMalloc();
+    std::copy(unaryInput.begin(), unaryInput.end(),
+              input->getRawDataPtr<float *>());
+    if (inplace)
+        op->getOutput()->setDataBlob(make_ref<BlobObj>(
+            runtime, input->getRawDataPtr<void *>()));
+
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(ansVec));
+}
+
+TEST(Relu, NativeCpu) {
+    testUnaryNativeCpu<ReluObj>({0, 0, 0, 0.5, 2, 4}, false);
+    testUnaryNativeCpu<ReluObj>({0, 0, 0, 0.5, 2, 4}, true);
+}
+
+TEST(Clip, NativeCpu) {
+    using std::nullopt;
+    testUnaryNativeCpu<ClipObj>({-1, -1, 0, 0.5, 1, 1}, false, -1.f, 1.f);
+    testUnaryNativeCpu<ClipObj>({-1, -1, 0, 0.5, 2, 4}, false, -1.f, nullopt);
+    testUnaryNativeCpu<ClipObj>({-3, -1.5, 0, 0.5, 1, 1}, false, nullopt, 1.f);
+    testUnaryNativeCpu<ClipObj>({-3, -1.5, 0, 0.5, 2, 4}, false, nullopt,
+                                nullopt);
+    testUnaryNativeCpu<ClipObj>({-1, -1, 0, 0.5, 1, 1}, true, -1.f, 1.f);
+    testUnaryNativeCpu<ClipObj>({-3, -1.5, 0, 0.5, 2, 4}, true, nullopt,
+                                nullopt);
+}
+
+} // namespace infini
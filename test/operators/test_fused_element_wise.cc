@@ -0,0 +1,29 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/fused_element_wise.h"
+
+#include "test.h"
+
+namespace infini {
+
+    TEST(FusedElementWise, ShapeInference)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        using Instruction = FusedElementWiseObj::Instruction;
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor i0 = g->addTensor({2, 1, 4}, DataType::Float32);
+            Tensor i1 = g->addTensor({3, 1}, DataType::Float32);
+            Tensor i2 = g->addTensor({4}, DataType::Float32);
+            // relu(i0 + i1) * i2
+            auto op = g->addOp<FusedElementWiseObj>(
+                TensorVec{i0, i1, i2}, nullptr,
+                vector<Instruction>{{OpType::Add, 0, 1, {}, {}},
+                                    {OpType::Relu, 3, -1, {}, {}},
+                                    {OpType::Mul, 4, 2, {}, {}}});
+            EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+            EXPECT_EQ(op->getOutput()->getDType(), DataType::Float32);
+        }
+    }
+
+} // namespace infini
@@ -54,4 +54,22 @@ namespace infini
         }
     }
 
-}; // namespace infini
\ No newline at end of file
+    TEST(Matmul, EpilogueBias)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto A = g->addTensor(Shape{2, 3, 5});
+        auto B = g->addTensor(Shape{5, 4});
+        auto bias = g->addTensor(Shape{1, 4});
+        auto matmul = g->addOp<MatmulObj>(A, B, nullptr, false, false, bias,
+                                          MatmulObj::Epilogue{0.f, 6.f});
+        EXPECT_EQ(matmul->getOutput()->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(matmul->getBias(), bias);
+        EXPECT_EQ(matmul->getEpilogue().max, 6.f);
+        // A bias must be a single row of the output.
+        auto wrongBias = g->addTensor(Shape{3, 4});
+        EXPECT_ANY_THROW(
+            g->addOp<MatmulObj>(A, B, nullptr, false, false, wrongBias));
+    }
+
+}; // namespace infini
@@ -0,0 +1,18 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/split.h"
+#include "test.h"
+
+namespace infini {
+TEST(Split, ShapeInfer) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto t = g->addTensor({1, 3, 2, 9}, DataType::Float32);
+
+    auto op = g->addOp<SplitObj>(t, std::nullopt, -1, vector<int>{4, 5});
+    ASSERT_EQ(op->getOutputs().size(), 2);
+    EXPECT_EQ(op->getOutputs()[0]->getDims(), (Shape{1, 3, 2, 4}));
+    EXPECT_EQ(op->getOutputs()[1]->getDims(), (Shape{1, 3, 2, 5}));
+    EXPECT_EQ(op->getDim(), 3);
+}
+} // namespace infini